@@ -0,0 +1,371 @@
+#include "CombBankReverb.h"
+
+namespace
+{
+    // Freeverb tunings at 44.1 kHz, as used by juce::Reverb
+    const short combTunings[] = { 1116, 1188, 1277, 1356, 1422, 1491, 1557, 1617 };
+    const short allPassTunings[] = { 556, 441, 341, 225 };
+    const int stereoSpread = 23;
+
+    const float roomScaleFactor = 0.28f;
+    const float roomOffset = 0.7f;
+}
+
+template <typename SampleType>
+CombBankReverb<SampleType>::CombBankReverb()
+{
+    setParameters(Parameters());
+    setSampleRate(44100.0);
+}
+
+template <typename SampleType>
+void CombBankReverb<SampleType>::setParameters(const Parameters& newParams)
+{
+    const float wetScaleFactor = 3.0f;
+    const float dryScaleFactor = 2.0f;
+
+    const float wet = newParams.wetLevel * wetScaleFactor;
+    dryGain.setTargetValue(newParams.dryLevel * dryScaleFactor);
+    wetGain1.setTargetValue(0.5f * wet * (1.0f + newParams.width));
+    wetGain2.setTargetValue(0.5f * wet * (1.0f - newParams.width));
+
+    gain = isFrozen(newParams.freezeMode) ? SampleType (0) : SampleType (0.015);
+    parameters = newParams;
+    updateDamping();
+}
+
+template <typename SampleType>
+double CombBankReverb<SampleType>::getTailLengthSeconds(const Parameters& parameters, double decibels)
+{
+    if (isFrozen(parameters.freezeMode))
+        return std::numeric_limits<double>::infinity();
+
+    const double combFeedback = parameters.roomSize * roomScaleFactor + roomOffset;
+    const double combSeconds = (combTunings[numCombs - 1] + stereoSpread) / 44100.0;
+    const double combTail = decibels / -juce::Decibels::gainToDecibels(combFeedback) * combSeconds;
+
+    // Each allpass loses 6 dB per pass; bound the chain by the sum of its delays
+    double allPassSeconds = 0.0;
+
+    for (auto tuning : allPassTunings)
+        allPassSeconds += (tuning + stereoSpread) / 44100.0;
+
+    const double allPassTail = decibels / -juce::Decibels::gainToDecibels(0.5) * allPassSeconds;
+
+    return combTail + allPassTail;
+}
+
+template <typename SampleType>
+void CombBankReverb<SampleType>::updateDamping() noexcept
+{
+    const float dampScaleFactor = 0.4f;
+
+    if (isFrozen(parameters.freezeMode))
+    {
+        damping.setTargetValue(0);
+        feedback.setTargetValue(1);
+    }
+    else
+    {
+        damping.setTargetValue(parameters.damping * dampScaleFactor);
+        feedback.setTargetValue(parameters.roomSize * roomScaleFactor + roomOffset);
+    }
+}
+
+template <typename SampleType>
+void CombBankReverb<SampleType>::setSampleRate(double sampleRate)
+{
+    jassert(sampleRate > 0);
+
+    const int intSampleRate = (int) sampleRate;
+    int combSizes[numCombLanes];
+    int allPassSizes[numChannels][numAllPasses];
+    size_t totalSize = 2 * (size_t) (maxChunkSize * numCombLanes) + (size_t) simdWidth;
+
+    for (int i = 0; i < numCombs; ++i)
+    {
+        combSizes[i] = (intSampleRate * combTunings[i]) / 44100;
+        combSizes[numCombs + i] = (intSampleRate * (combTunings[i] + stereoSpread)) / 44100;
+    }
+
+    for (int i = 0; i < numAllPasses; ++i)
+    {
+        allPassSizes[0][i] = (intSampleRate * allPassTunings[i]) / 44100;
+        allPassSizes[1][i] = (intSampleRate * (allPassTunings[i] + stereoSpread)) / 44100;
+    }
+
+    for (auto size : combSizes)
+        totalSize += (size_t) size;
+
+    for (auto& channelSizes : allPassSizes)
+        for (auto size : channelSizes)
+            totalSize += (size_t) size;
+
+    // One allocation for everything; the tiles go first so they stay SIMD aligned
+    if (totalSize != storageSize)
+    {
+        storage.allocate(totalSize, true);
+        storageSize = totalSize;
+    }
+
+    SampleType* next = SIMDType::getNextSIMDAlignedPtr(storage.getData());
+    combOutputTile = next;
+    next += maxChunkSize * numCombLanes;
+    combInputTile = next;
+    next += maxChunkSize * numCombLanes;
+
+    // Like juce::Reverb, a filter only restarts its read position if its size changed
+    auto assign = [&next] (DelayBuffer& buffer, int size)
+    {
+        if (size != buffer.size)
+            buffer.index = 0;
+
+        buffer.data = next;
+        buffer.size = size;
+        next += size;
+    };
+
+    chunkLimit = maxChunkSize;
+
+    for (int lane = 0; lane < numCombLanes; ++lane)
+    {
+        assign(combs[lane], combSizes[lane]);
+        chunkLimit = juce::jmin(chunkLimit, combSizes[lane]);
+    }
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        for (int i = 0; i < numAllPasses; ++i)
+        {
+            assign(allPasses[channel][i], allPassSizes[channel][i]);
+            chunkLimit = juce::jmin(chunkLimit, allPassSizes[channel][i]);
+        }
+    }
+
+    chunkLimit = juce::jmax(1, chunkLimit);
+    reset();
+
+    const double smoothTime = 0.01;
+    damping.reset(sampleRate, smoothTime);
+    feedback.reset(sampleRate, smoothTime);
+    dryGain.reset(sampleRate, smoothTime);
+    wetGain1.reset(sampleRate, smoothTime);
+    wetGain2.reset(sampleRate, smoothTime);
+}
+
+template <typename SampleType>
+void CombBankReverb<SampleType>::reset()
+{
+    for (auto& comb : combs)
+        std::fill(comb.data, comb.data + comb.size, 0.0f);
+
+    for (auto& channelAllPasses : allPasses)
+        for (auto& allPass : channelAllPasses)
+            std::fill(allPass.data, allPass.data + allPass.size, 0.0f);
+
+    std::fill(std::begin(combLast), std::end(combLast), 0.0f);
+}
+
+template <typename SampleType>
+void CombBankReverb<SampleType>::processCombs(const SampleType* input, const SampleType* dampValues, const SampleType* feedbackValues,
+                                  int numSamples, int numLanes) noexcept
+{
+    // Gather each comb's outputs for the chunk into the time x comb tile, in contiguous
+    // runs up to the buffer wrap
+    for (int lane = 0; lane < numLanes; ++lane)
+    {
+        const auto& comb = combs[lane];
+        const int firstRun = juce::jmin(numSamples, comb.size - comb.index);
+        SampleType* column = combOutputTile + lane;
+
+        for (int t = 0; t < firstRun; ++t)
+            column[t * numCombLanes] = comb.data[comb.index + t];
+
+        for (int t = firstRun; t < numSamples; ++t)
+            column[t * numCombLanes] = comb.data[t - firstRun];
+    }
+
+    // The damped feedback recursion, one time step at a time across the comb lanes
+    const int numRegisters = numLanes / simdWidth;
+    SIMDType last[numCombLanes / simdWidth];
+
+    for (int r = 0; r < numRegisters; ++r)
+        last[r] = SIMDType::fromRawArray(combLast + r * simdWidth);
+
+    for (int t = 0; t < numSamples; ++t)
+    {
+        const SampleType damp = dampValues[t];
+        const auto dampRegister = SIMDType::expand(damp);
+        const auto keepRegister = SIMDType::expand(SampleType (1) - damp);
+        const auto feedbackRegister = SIMDType::expand(feedbackValues[t]);
+        const auto inputRegister = SIMDType::expand(input[t]);
+
+        const SampleType* outputs = combOutputTile + t * numCombLanes;
+        SampleType* writes = combInputTile + t * numCombLanes;
+
+        for (int r = 0; r < numRegisters; ++r)
+        {
+            const auto output = SIMDType::fromRawArray(outputs + r * simdWidth);
+            last[r] = (output * keepRegister) + (last[r] * dampRegister);
+            JUCE_UNDENORMALISE(last[r]);
+
+            auto temp = inputRegister + (last[r] * feedbackRegister);
+            JUCE_UNDENORMALISE(temp);
+            temp.copyToRawArray(writes + r * simdWidth);
+        }
+    }
+
+    for (int r = 0; r < numRegisters; ++r)
+        last[r].copyToRawArray(combLast + r * simdWidth);
+
+    // Scatter the new values back into each comb's buffer
+    for (int lane = 0; lane < numLanes; ++lane)
+    {
+        auto& comb = combs[lane];
+        const int firstRun = juce::jmin(numSamples, comb.size - comb.index);
+        const SampleType* column = combInputTile + lane;
+
+        for (int t = 0; t < firstRun; ++t)
+            comb.data[comb.index + t] = column[t * numCombLanes];
+
+        for (int t = firstRun; t < numSamples; ++t)
+            comb.data[t - firstRun] = column[t * numCombLanes];
+
+        comb.index += numSamples;
+
+        if (comb.index >= comb.size)
+            comb.index -= comb.size;
+    }
+}
+
+template <typename SampleType>
+void CombBankReverb<SampleType>::processAllPass(DelayBuffer& allPass, SampleType* samples, int numSamples) noexcept
+{
+    // Contiguous runs up to each wrap, so the inner loop can vectorise
+    for (int done = 0; done < numSamples;)
+    {
+        const int run = juce::jmin(numSamples - done, allPass.size - allPass.index);
+        SampleType* buffer = allPass.data + allPass.index;
+        SampleType* block = samples + done;
+
+        for (int t = 0; t < run; ++t)
+        {
+            const SampleType bufferedValue = buffer[t];
+            SampleType temp = block[t] + (bufferedValue * 0.5f);
+            JUCE_UNDENORMALISE(temp);
+            buffer[t] = temp;
+            block[t] = bufferedValue - block[t];
+        }
+
+        allPass.index += run;
+
+        if (allPass.index >= allPass.size)
+            allPass.index = 0;
+
+        done += run;
+    }
+}
+
+template <typename SampleType>
+void CombBankReverb<SampleType>::processStereo(SampleType* left, SampleType* right, int numSamples) noexcept
+{
+    jassert(left != nullptr && right != nullptr);
+
+    SampleType input[maxChunkSize], dampValues[maxChunkSize], feedbackValues[maxChunkSize];
+    SampleType outLeft[maxChunkSize], outRight[maxChunkSize];
+
+    for (int start = 0; start < numSamples; start += chunkLimit)
+    {
+        const int chunkSize = juce::jmin(chunkLimit, numSamples - start);
+
+        for (int t = 0; t < chunkSize; ++t)
+        {
+            input[t] = (left[start + t] + right[start + t]) * gain;
+            dampValues[t] = damping.getNextValue();
+            feedbackValues[t] = feedback.getNextValue();
+        }
+
+        processCombs(input, dampValues, feedbackValues, chunkSize, numCombLanes);
+
+        // Accumulate the comb filters in parallel, in the same order as juce::Reverb
+        for (int t = 0; t < chunkSize; ++t)
+        {
+            const SampleType* outputs = combOutputTile + t * numCombLanes;
+            SampleType outL = 0, outR = 0;
+
+            for (int j = 0; j < numCombs; ++j)
+            {
+                outL += outputs[j];
+                outR += outputs[numCombs + j];
+            }
+
+            outLeft[t] = outL;
+            outRight[t] = outR;
+        }
+
+        // Run the allpass filters in series
+        for (int j = 0; j < numAllPasses; ++j)
+        {
+            processAllPass(allPasses[0][j], outLeft, chunkSize);
+            processAllPass(allPasses[1][j], outRight, chunkSize);
+        }
+
+        for (int t = 0; t < chunkSize; ++t)
+        {
+            const SampleType dry = dryGain.getNextValue();
+            const SampleType wet1 = wetGain1.getNextValue();
+            const SampleType wet2 = wetGain2.getNextValue();
+            const int i = start + t;
+
+            left[i] = outLeft[t] * wet1 + outRight[t] * wet2 + left[i] * dry;
+            right[i] = outRight[t] * wet1 + outLeft[t] * wet2 + right[i] * dry;
+        }
+    }
+}
+
+template <typename SampleType>
+void CombBankReverb<SampleType>::processMono(SampleType* samples, int numSamples) noexcept
+{
+    SampleType input[maxChunkSize], dampValues[maxChunkSize], feedbackValues[maxChunkSize];
+    SampleType output[maxChunkSize];
+
+    for (int start = 0; start < numSamples; start += chunkLimit)
+    {
+        const int chunkSize = juce::jmin(chunkLimit, numSamples - start);
+
+        for (int t = 0; t < chunkSize; ++t)
+        {
+            input[t] = samples[start + t] * gain;
+            dampValues[t] = damping.getNextValue();
+            feedbackValues[t] = feedback.getNextValue();
+        }
+
+        // Only the left channel's combs and allpasses, as in juce::Reverb::processMono()
+        processCombs(input, dampValues, feedbackValues, chunkSize, numCombs);
+
+        for (int t = 0; t < chunkSize; ++t)
+        {
+            const SampleType* outputs = combOutputTile + t * numCombLanes;
+            SampleType out = 0;
+
+            for (int j = 0; j < numCombs; ++j)
+                out += outputs[j];
+
+            output[t] = out;
+        }
+
+        for (int j = 0; j < numAllPasses; ++j)
+            processAllPass(allPasses[0][j], output, chunkSize);
+
+        for (int t = 0; t < chunkSize; ++t)
+        {
+            const SampleType dry = dryGain.getNextValue();
+            const SampleType wet1 = wetGain1.getNextValue();
+
+            samples[start + t] = output[t] * wet1 + samples[start + t] * dry;
+        }
+    }
+}
+
+template class CombBankReverb<float>;
+template class CombBankReverb<double>;
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <juce_dsp/juce_dsp.h>
+
+// Drop-in replacement for juce::dsp::Reverb (Freeverb: 8 parallel damped combs and 4
+// series allpasses per channel) that runs the 16 combs of both channels together on
+// SIMDRegister lanes.
+//
+// Tunings, parameter scaling, the 10 ms parameter smoothing and the arithmetic itself,
+// operation for operation, follow juce::Reverb, so the output matches it sample for
+// sample. Every delay buffer and the scratch tiles live in one aligned allocation.
+//
+// Processing runs in chunks no longer than the shortest delay, so inside a chunk no
+// filter reads a value it has written. Each chunk of comb outputs is transposed into a
+// time x comb tile, the damped feedback recursion steps through time across all comb
+// lanes at once, and the results are transposed back. The allpasses then run a whole
+// chunk at a time per filter.
+//
+// The float instantiation is the one that matches juce::Reverb; the double one runs the
+// same arithmetic on double delay lines and smoothed gains.
+template <typename SampleType>
+class CombBankReverb
+{
+public:
+    using Parameters = juce::Reverb::Parameters;
+
+    CombBankReverb();
+    ~CombBankReverb() = default;
+
+    void setParameters(const Parameters& newParams);
+    const Parameters& getParameters() const noexcept { return parameters; }
+
+    void prepare(const juce::dsp::ProcessSpec& spec) { setSampleRate(spec.sampleRate); }
+    void reset();
+
+    // Time for the output to fall by `decibels` once the input stops: the longest comb's
+    // feedback (damping only shortens it) plus the allpass chain ringing out. Infinite
+    // while frozen.
+    static double getTailLengthSeconds(const Parameters& parameters, double decibels);
+
+    // Same channel handling as juce::dsp::Reverb: mono in/out or stereo in/out
+    template <typename ProcessContext>
+    void process(const ProcessContext& context) noexcept
+    {
+        const auto& inputBlock = context.getInputBlock();
+        auto& outputBlock = context.getOutputBlock();
+        const auto numInChannels = inputBlock.getNumChannels();
+        const auto numOutChannels = outputBlock.getNumChannels();
+        const auto numSamples = outputBlock.getNumSamples();
+
+        jassert(inputBlock.getNumSamples() == numSamples);
+
+        if (context.usesSeparateInputAndOutputBlocks())
+            outputBlock.copyFrom(inputBlock);
+
+        if (context.isBypassed)
+            return;
+
+        if (numInChannels == 1 && numOutChannels == 1)
+            processMono(outputBlock.getChannelPointer(0), (int) numSamples);
+        else if (numInChannels == 2 && numOutChannels == 2)
+            processStereo(outputBlock.getChannelPointer(0), outputBlock.getChannelPointer(1), (int) numSamples);
+        else
+            jassertfalse; // invalid channel configuration
+    }
+
+    void processStereo(SampleType* left, SampleType* right, int numSamples) noexcept;
+    void processMono(SampleType* samples, int numSamples) noexcept;
+
+private:
+    enum { numCombs = 8, numAllPasses = 4, numChannels = 2 };
+
+    // Comb lanes 0-7 belong to the left channel, 8-15 to the right
+    static constexpr int numCombLanes = numCombs * numChannels;
+    static constexpr int maxChunkSize = 64;
+
+    using SIMDType = juce::dsp::SIMDRegister<SampleType>;
+    static constexpr int simdWidth = (int) SIMDType::SIMDNumElements;
+
+    static_assert(numCombs % simdWidth == 0, "A channel's combs must fill whole SIMD registers");
+
+    struct DelayBuffer
+    {
+        SampleType* data = nullptr;
+        int size = 0;
+        int index = 0;
+    };
+
+    Parameters parameters;
+    SampleType gain = 0;
+    juce::SmoothedValue<SampleType> damping, feedback, dryGain, wetGain1, wetGain2;
+
+    juce::HeapBlock<SampleType> storage;
+    size_t storageSize = 0;
+    DelayBuffer combs[numCombLanes];
+    DelayBuffer allPasses[numChannels][numAllPasses];
+    alignas (sizeof (SIMDType)) SampleType combLast[numCombLanes] = {};
+
+    // maxChunkSize x numCombLanes tiles: what the combs read, and what they write back
+    SampleType* combOutputTile = nullptr;
+    SampleType* combInputTile = nullptr;
+
+    // Shortest delay of any filter, capped at maxChunkSize
+    int chunkLimit = 1;
+
+    void setSampleRate(double sampleRate);
+    void updateDamping() noexcept;
+
+    void processCombs(const SampleType* input, const SampleType* dampValues, const SampleType* feedbackValues,
+                      int numSamples, int numLanes) noexcept;
+    static void processAllPass(DelayBuffer& allPass, SampleType* samples, int numSamples) noexcept;
+
+    static bool isFrozen(float freezeMode) noexcept { return freezeMode >= 0.5f; }
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(CombBankReverb)
+};
@@ -0,0 +1,78 @@
+#include "DCBlocker.h"
+
+template <typename SampleType>
+void DCBlocker<SampleType>::prepare(int numChannels)
+{
+    numChannelsPrepared = juce::jmax(1, numChannels);
+    numRegisters = (numChannelsPrepared + simdWidth - 1) / simdWidth;
+    frameSize = numRegisters * simdWidth;
+
+    previousInputs.assign((size_t) numRegisters, SIMDType::expand(0));
+    previousOutputs.assign((size_t) numRegisters, SIMDType::expand(0));
+
+    frameStorage.calloc((size_t) (chunkSize * frameSize + simdWidth));
+    frames = SIMDType::getNextSIMDAlignedPtr(frameStorage.getData());
+}
+
+template <typename SampleType>
+void DCBlocker<SampleType>::reset()
+{
+    std::fill(previousInputs.begin(), previousInputs.end(), SIMDType::expand(0));
+    std::fill(previousOutputs.begin(), previousOutputs.end(), SIMDType::expand(0));
+}
+
+template <typename SampleType>
+void DCBlocker<SampleType>::process(const juce::dsp::AudioBlock<SampleType>& block) noexcept
+{
+    const int numChannels = juce::jmin((int) block.getNumChannels(), numChannelsPrepared);
+    const int numSamples = (int) block.getNumSamples();
+
+    if (frames == nullptr || numChannels == 0)
+        return;
+
+    const auto coefficientRegister = SIMDType::expand(coefficient);
+
+    for (int start = 0; start < numSamples; start += chunkSize)
+    {
+        const int length = juce::jmin(chunkSize, numSamples - start);
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            const SampleType* input = block.getChannelPointer((size_t) channel) + start;
+
+            for (int t = 0; t < length; ++t)
+                frames[t * frameSize + channel] = input[t];
+        }
+
+        // Prepared channels missing from this block see silence; the padding lanes
+        // beyond them are never written and stay zero
+        for (int channel = numChannels; channel < numChannelsPrepared; ++channel)
+            for (int t = 0; t < length; ++t)
+                frames[t * frameSize + channel] = 0;
+
+        for (int t = 0; t < length; ++t)
+        {
+            SampleType* frame = frames + t * frameSize;
+
+            for (int r = 0; r < numRegisters; ++r)
+            {
+                const auto input = SIMDType::fromRawArray(frame + r * simdWidth);
+                const auto output = input - previousInputs[(size_t) r] + coefficientRegister * previousOutputs[(size_t) r];
+                previousInputs[(size_t) r] = input;
+                previousOutputs[(size_t) r] = output;
+                output.copyToRawArray(frame + r * simdWidth);
+            }
+        }
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            SampleType* output = block.getChannelPointer((size_t) channel) + start;
+
+            for (int t = 0; t < length; ++t)
+                output[t] = frames[t * frameSize + channel];
+        }
+    }
+}
+
+template class DCBlocker<float>;
+template class DCBlocker<double>;
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <juce_dsp/juce_dsp.h>
+#include <vector>
+
+// One-pole DC blocker, y[n] = x[n] - x[n-1] + 0.995 y[n-1], for any number of channels.
+//
+// The recursion runs serially in time but independently per channel, so it is
+// vectorised across channels: each chunk of the block is transposed into frames (one
+// value per channel), every SIMD register steps a group of channels through time
+// together, and the result is transposed back. Unused lanes of the last register carry
+// silence. Double precision halves the channels per register.
+template <typename SampleType>
+class DCBlocker
+{
+public:
+    DCBlocker() = default;
+    ~DCBlocker() = default;
+
+    void prepare(int numChannels);
+    void reset();
+
+    // In place, on at most the prepared number of channels
+    void process(const juce::dsp::AudioBlock<SampleType>& block) noexcept;
+
+private:
+    using SIMDType = juce::dsp::SIMDRegister<SampleType>;
+    static constexpr int simdWidth = (int) SIMDType::SIMDNumElements;
+    static constexpr int chunkSize = 64;
+    static constexpr SampleType coefficient = (SampleType) 0.995;
+
+    int numChannelsPrepared = 0;
+    int numRegisters = 0;
+    int frameSize = 0; // channels rounded up to whole registers
+
+    // Per register of channels: previous input and previous output
+    std::vector<SIMDType> previousInputs, previousOutputs;
+
+    // chunkSize frames, SIMD aligned
+    juce::HeapBlock<SampleType> frameStorage;
+    SampleType* frames = nullptr;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(DCBlocker)
+};
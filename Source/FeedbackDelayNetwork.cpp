@@ -0,0 +1,208 @@
+#include "FeedbackDelayNetwork.h"
+
+namespace
+{
+    // Line lengths are spread geometrically over this range at full room size
+    constexpr double shortestLineSeconds = 0.0297;
+    constexpr double longestLineSeconds = 0.0973;
+}
+
+template <typename SampleType>
+void FeedbackDelayNetwork<SampleType>::prepare(const juce::dsp::ProcessSpec& spec)
+{
+    sampleRate = spec.sampleRate;
+
+    // Room for the longest line at full size, plus the prime rounding
+    const int longestDelay = (int) std::ceil(longestLineSeconds * sampleRate) + 64;
+    const int capacity = juce::nextPowerOfTwo(longestDelay + 1);
+    capacityMask = capacity - 1;
+
+    memoryStorage.calloc((size_t) (capacity * maxLines + simdWidth));
+    lineMemory = SIMDType::getNextSIMDAlignedPtr(memoryStorage.getData());
+
+    numLines = -1;
+    setParameters(params);
+    reset();
+}
+
+template <typename SampleType>
+void FeedbackDelayNetwork<SampleType>::reset()
+{
+    if (lineMemory != nullptr)
+        std::fill(lineMemory, lineMemory + (capacityMask + 1) * maxLines, SampleType (0));
+
+    std::fill(std::begin(dampingState), std::end(dampingState), SampleType (0));
+    writePosition = 0;
+}
+
+template <typename SampleType>
+void FeedbackDelayNetwork<SampleType>::setParameters(const Parameters& newParameters)
+{
+    const int newNumLines = newParameters.numLines > 8 ? maxLines : 8;
+    const bool delaysChanged = newNumLines != numLines || newParameters.roomSize != params.roomSize;
+
+    params = newParameters;
+
+    if (newNumLines != numLines)
+    {
+        // The interleaved layout depends on the line count, so start from silence
+        numLines = newNumLines;
+        reset();
+
+        // Each input feeds every other line, and each output taps every line, with sign
+        // patterns taken from different Hadamard rows so the two sides decorrelate
+        const SampleType scale = std::sqrt(SampleType (2) / (SampleType) numLines);
+
+        for (int line = 0; line < maxLines; ++line)
+        {
+            const bool active = line < numLines;
+            const SampleType inputSign = ((line >> 1) & 1) != 0 ? -scale : scale;
+            leftInputGains[line] = active && (line & 1) == 0 ? inputSign : SampleType (0);
+            rightInputGains[line] = active && (line & 1) != 0 ? inputSign : SampleType (0);
+            leftOutputGains[line] = active ? (((line >> 2) & 1) != 0 ? -scale : scale) : SampleType (0);
+            rightOutputGains[line] = active ? ((((line >> 2) ^ line) & 1) != 0 ? -scale : scale) : SampleType (0);
+        }
+    }
+
+    if (delaysChanged)
+        updateDelays();
+
+    updateGains();
+}
+
+template <typename SampleType>
+double FeedbackDelayNetwork<SampleType>::getTailLengthSeconds(const Parameters& parameters, double decibels)
+{
+    const double scale = 0.25 + 0.75 * juce::jlimit(0.0f, 1.0f, parameters.roomSize);
+    return longestLineSeconds * scale + juce::jmax(0.0f, parameters.decaySeconds) * decibels / 60.0;
+}
+
+template <typename SampleType>
+void FeedbackDelayNetwork<SampleType>::updateDelays()
+{
+    const double scale = 0.25 + 0.75 * juce::jlimit(0.0f, 1.0f, params.roomSize);
+    int previous = 0;
+
+    // Mutually prime lengths keep the modes of the lines from lining up
+    for (int line = 0; line < numLines; ++line)
+    {
+        const double position = (double) line / (double) (numLines - 1);
+        const double seconds = shortestLineSeconds * std::pow(longestLineSeconds / shortestLineSeconds, position);
+        const int length = nextPrime(juce::jmax(previous + 1, juce::roundToInt(seconds * scale * sampleRate)));
+
+        delays[line] = juce::jmin(length, capacityMask);
+        previous = length;
+    }
+}
+
+template <typename SampleType>
+void FeedbackDelayNetwork<SampleType>::updateGains()
+{
+    // Each line loses 60 dB over decaySeconds regardless of its length
+    const double decaySamples = juce::jmax(0.01f, params.decaySeconds) * sampleRate;
+
+    for (int line = 0; line < maxLines; ++line)
+        lineGains[line] = line < numLines ? (SampleType) std::pow(10.0, -3.0 * delays[line] / decaySamples) : SampleType (0);
+
+    dampingCoefficient = juce::jlimit(0.0f, 1.0f, params.damping) * 0.4f;
+
+    const float width = juce::jlimit(0.0f, 1.0f, params.width);
+    wet1 = 0.5f * (1.0f + width);
+    wet2 = 0.5f * (1.0f - width);
+}
+
+template <typename SampleType>
+int FeedbackDelayNetwork<SampleType>::nextPrime(int value)
+{
+    for (value = juce::jmax(2, value);; ++value)
+    {
+        bool isPrime = true;
+
+        for (int divisor = 2; divisor * divisor <= value && isPrime; ++divisor)
+            isPrime = value % divisor != 0;
+
+        if (isPrime)
+            return value;
+    }
+}
+
+template <typename SampleType>
+void FeedbackDelayNetwork<SampleType>::process(const juce::dsp::AudioBlock<SampleType>& block, const Wavefolder<SampleType>* folder)
+{
+    const int numChannels = (int) block.getNumChannels();
+    const int numSamples = (int) block.getNumSamples();
+
+    if (numChannels == 0 || lineMemory == nullptr)
+        return;
+
+    SampleType* left = block.getChannelPointer(0);
+    SampleType* right = numChannels > 1 ? block.getChannelPointer(1) : nullptr;
+
+    const int numRegisters = numLines / simdWidth;
+    const SampleType householderScale = SampleType (2) / (SampleType) numLines;
+    const auto damping = SIMDType::expand(dampingCoefficient);
+    const auto pass = SIMDType::expand(SampleType (1) - dampingCoefficient);
+
+    alignas (sizeof (SIMDType)) SampleType frame[maxLines];
+
+    for (int sample = 0; sample < numSamples; ++sample)
+    {
+        // Each line is read at its own delay
+        for (int line = 0; line < numLines; ++line)
+            frame[line] = lineMemory[((writePosition - delays[line]) & capacityMask) * numLines + line];
+
+        // Output taps, then decay and one-pole damping
+        auto leftSum = SIMDType::expand(0);
+        auto rightSum = SIMDType::expand(0);
+
+        for (int r = 0; r < numRegisters; ++r)
+        {
+            const int offset = r * simdWidth;
+            const auto lineOutput = SIMDType::fromRawArray(frame + offset);
+
+            leftSum += lineOutput * SIMDType::fromRawArray(leftOutputGains + offset);
+            rightSum += lineOutput * SIMDType::fromRawArray(rightOutputGains + offset);
+
+            const auto damped = lineOutput * SIMDType::fromRawArray(lineGains + offset) * pass
+                              + SIMDType::fromRawArray(dampingState + offset) * damping;
+            damped.copyToRawArray(dampingState + offset);
+            damped.copyToRawArray(frame + offset);
+        }
+
+        // Fold every line before it is fed back
+        if (folder != nullptr)
+            folder->foldVector(frame, numLines);
+
+        // Householder feedback matrix: frame - (2 / N) * sum(frame)
+        auto total = SIMDType::expand(0);
+
+        for (int r = 0; r < numRegisters; ++r)
+            total += SIMDType::fromRawArray(frame + r * simdWidth);
+
+        const auto reflection = SIMDType::expand(total.sum() * householderScale);
+        const auto leftInput = SIMDType::expand(left[sample]);
+        const auto rightInput = SIMDType::expand(right != nullptr ? right[sample] : left[sample]);
+        SampleType* writeFrame = lineMemory + writePosition * numLines;
+
+        for (int r = 0; r < numRegisters; ++r)
+        {
+            const int offset = r * simdWidth;
+            const auto feedback = SIMDType::fromRawArray(frame + offset) - reflection
+                                + leftInput * SIMDType::fromRawArray(leftInputGains + offset)
+                                + rightInput * SIMDType::fromRawArray(rightInputGains + offset);
+            feedback.copyToRawArray(writeFrame + offset);
+        }
+
+        writePosition = (writePosition + 1) & capacityMask;
+
+        const SampleType leftOutput = leftSum.sum();
+        const SampleType rightOutput = rightSum.sum();
+        left[sample] = leftOutput * wet1 + rightOutput * wet2;
+
+        if (right != nullptr)
+            right[sample] = rightOutput * wet1 + leftOutput * wet2;
+    }
+}
+
+template class FeedbackDelayNetwork<float>;
+template class FeedbackDelayNetwork<double>;
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <juce_dsp/juce_dsp.h>
+#include "Wavefolder.h"
+
+// Feedback delay network reverb with an optional wavefolder inside the feedback path.
+//
+// The 8 or 16 delay lines share one interleaved buffer: every write position holds one
+// frame with a value per line, so the per-sample write is a single contiguous SIMD store.
+// Decay gain, damping, the in-loop fold and the Householder feedback matrix all run
+// across lines on SIMDRegister lanes; only the reads, which sit at a different delay per
+// line, are scalar. The cost per sample is linear in the line count.
+template <typename SampleType>
+class FeedbackDelayNetwork
+{
+public:
+    static constexpr int maxLines = 16;
+
+    struct Parameters
+    {
+        int numLines = 8;           // 8 or 16
+        float roomSize = 0.5f;      // 0..1, scales the line lengths
+        float decaySeconds = 2.0f;  // time for the loop to lose 60 dB
+        float damping = 0.5f;       // 0..1, high frequency loss per pass through a line
+        float width = 1.0f;         // 0 = mono, 1 = full stereo
+    };
+
+    FeedbackDelayNetwork() = default;
+    ~FeedbackDelayNetwork() = default;
+
+    void prepare(const juce::dsp::ProcessSpec& spec);
+    void reset();
+    void setParameters(const Parameters& newParameters);
+
+    // Time for the output to fall by `decibels` once the input stops: the decay at the
+    // RT60 rate plus one pass through the longest line
+    static double getTailLengthSeconds(const Parameters& parameters, double decibels);
+
+    // Replaces the first one or two channels of the block with the reverb output. When
+    // folder is not null its vector fold (see Wavefolder::setVectorFoldParameters) runs
+    // on every line on each pass through the loop.
+    void process(const juce::dsp::AudioBlock<SampleType>& block, const Wavefolder<SampleType>* folder);
+
+private:
+    using SIMDType = juce::dsp::SIMDRegister<SampleType>;
+    static constexpr int simdWidth = (int) SIMDType::SIMDNumElements;
+
+    static_assert(maxLines % simdWidth == 0 && 8 % simdWidth == 0,
+                  "Line counts must fill whole SIMD registers");
+
+    Parameters params;
+    double sampleRate = 44100.0;
+    int numLines = 8;
+
+    // Interleaved line memory: frame f of line l lives at lineMemory[f * numLines + l]
+    juce::HeapBlock<SampleType> memoryStorage;
+    SampleType* lineMemory = nullptr;
+    int capacityMask = 0;
+    int writePosition = 0;
+
+    // Per-line state and coefficients, laid out for aligned SIMD loads
+    alignas (sizeof (SIMDType)) SampleType dampingState[maxLines] = {};
+    alignas (sizeof (SIMDType)) SampleType lineGains[maxLines] = {};
+    alignas (sizeof (SIMDType)) SampleType leftInputGains[maxLines] = {};
+    alignas (sizeof (SIMDType)) SampleType rightInputGains[maxLines] = {};
+    alignas (sizeof (SIMDType)) SampleType leftOutputGains[maxLines] = {};
+    alignas (sizeof (SIMDType)) SampleType rightOutputGains[maxLines] = {};
+    int delays[maxLines] = {};
+
+    SampleType dampingCoefficient = (SampleType) 0.2;
+    SampleType wet1 = 1, wet2 = 0;
+
+    void updateDelays();
+    void updateGains();
+
+    static int nextPrime(int value);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(FeedbackDelayNetwork)
+};
@@ -0,0 +1,425 @@
+#pragma once
+
+#include <juce_dsp/juce_dsp.h>
+#include <array>
+#include <cmath>
+#include "FoldShape.h"
+
+// Closed-form antiderivatives of the three Wavefolder fold shapes, for antiderivative
+// anti-aliasing (ADAA). fold() is the same transfer curve as Wavefolder::foldSignal();
+// first() and second() are its first and second antiderivatives. Everything is evaluated
+// in double because ADAA divides differences of these values by small input steps.
+//
+// Every shape is odd, so the maths works on |x| and restores the sign (or parity) at the
+// end. The triangle fold integrates exactly in polynomials. The tanh fold needs log cosh
+// and, for the second antiderivative, the dilogarithm, all from one exp() and one
+// log1p() per sample; the dilogarithm is a fixed-degree polynomial. The sine fold is
+// closed form while the symmetry warp is neutral. Warping the sine argument leaves no
+// elementary antiderivative, so one folded segment is integrated into a small table
+// whenever the symmetry changes; the periodic continuation stays closed form.
+//
+// The evaluators are templated on the shape so a block loop can pick its curve once;
+// the untemplated overloads dispatch on the current shape per call.
+class FoldAntiderivatives
+{
+public:
+    FoldAntiderivatives() = default;
+
+    // symmetry is the already-centred -1..1 value foldSignal() passes to the fold shapes.
+    // Returns true if the curve changed.
+    bool update(float newThreshold, float newSymmetry, float newShape)
+    {
+        const FoldShape newShapeType = getFoldShape(newShape);
+
+        if (newThreshold == threshold && newSymmetry == symmetry && newShapeType == shape)
+            return false;
+
+        threshold = newThreshold;
+        symmetry = newSymmetry;
+        shape = newShapeType;
+
+        const double s = symmetry;
+
+        if (shape == FoldShape::triangle)
+        {
+            // basicFold() symmetry: gain = 1 + bias + slope * |o| / threshold
+            bias = s > 0.0 ? s : 0.0;
+            slope = s > 0.0 ? -s : s;
+            halfPeriodIntegral = trianglePrimitive(threshold);
+        }
+        else if (shape == FoldShape::sine)
+        {
+            if (s != 0.0)
+                buildSineTables();
+
+            segmentIntegral = sineSegmentFirst(1.0);
+        }
+        else
+        {
+            // tanhFold() symmetry: t' = (1 + bias) t + slope t^2, output max(0.05, 1 - t')
+            bias = s > 0.0 ? s : 0.0;
+            slope = s > 0.0 ? -s : std::max(-0.95, s);
+            updateTanhClip();
+        }
+        
+        return true;
+    }
+
+    FoldShape getShape() const noexcept { return shape; }
+
+    template <FoldShape foldShape>
+    double fold(double x) const
+    {
+        const double magnitude = std::abs(x);
+        const double sign = x < 0.0 ? -1.0 : 1.0;
+
+        if constexpr (foldShape == FoldShape::triangle)
+        {
+            bool rising;
+            const double output = triangle(magnitude, rising);
+            return sign * output * (1.0 + bias + slope * std::abs(output) / threshold);
+        }
+
+        if (magnitude <= threshold)
+            return x;
+
+        const double excess = magnitude / threshold - 1.0;
+
+        if constexpr (foldShape == FoldShape::sine)
+            return sign * threshold * sineShape(foldedAmount(excess));
+        else
+            return sign * threshold * tanhShape(excess);
+    }
+
+    template <FoldShape foldShape>
+    double first(double x) const
+    {
+        const double magnitude = std::abs(x);
+
+        if constexpr (foldShape == FoldShape::triangle)
+        {
+            // Rising segments integrate to P(o); falling ones mirror around P(threshold)
+            bool rising;
+            const double output = triangle(magnitude, rising);
+            const double primitive = trianglePrimitive(output);
+            return rising ? primitive : 2.0 * halfPeriodIntegral - primitive;
+        }
+
+        if (magnitude <= threshold)
+            return 0.5 * x * x;
+
+        const double excess = magnitude / threshold - 1.0;
+        const double t2 = threshold * threshold;
+        const double excessIntegral = foldShape == FoldShape::sine ? sineFirst(excess) : tanhFirst(excess);
+        return 0.5 * t2 + t2 * excessIntegral;
+    }
+
+    template <FoldShape foldShape>
+    double second(double x) const
+    {
+        const double magnitude = std::abs(x);
+        const double sign = x < 0.0 ? -1.0 : 1.0;
+
+        if constexpr (foldShape == FoldShape::triangle)
+        {
+            // Linear growth at the average of first(), plus a periodic part
+            bool rising;
+            const double output = triangle(magnitude, rising);
+            return sign * (halfPeriodIntegral * (magnitude - output) + triangleSecondPrimitive(output));
+        }
+
+        if (magnitude <= threshold)
+            return x * x * x / 6.0;
+
+        const double excess = magnitude / threshold - 1.0;
+        const double t2 = threshold * threshold;
+        const double excessIntegral = foldShape == FoldShape::sine ? sineSecond(excess) : tanhSecond(excess);
+        return sign * (t2 * threshold / 6.0 + 0.5 * t2 * (magnitude - threshold) + t2 * threshold * excessIntegral);
+    }
+
+    double fold(double x) const
+    {
+        switch (shape)
+        {
+            case FoldShape::triangle: return fold<FoldShape::triangle>(x);
+            case FoldShape::sine:     return fold<FoldShape::sine>(x);
+            default:                  return fold<FoldShape::tanh>(x);
+        }
+    }
+
+    double first(double x) const
+    {
+        switch (shape)
+        {
+            case FoldShape::triangle: return first<FoldShape::triangle>(x);
+            case FoldShape::sine:     return first<FoldShape::sine>(x);
+            default:                  return first<FoldShape::tanh>(x);
+        }
+    }
+
+    double second(double x) const
+    {
+        switch (shape)
+        {
+            case FoldShape::triangle: return second<FoldShape::triangle>(x);
+            case FoldShape::sine:     return second<FoldShape::sine>(x);
+            default:                  return second<FoldShape::tanh>(x);
+        }
+    }
+
+private:
+    double threshold = -1.0;
+    double symmetry = 0.0;
+    FoldShape shape = FoldShape::triangle;
+
+    // Symmetry gains for the triangle and tanh shapes
+    double bias = 0.0, slope = 0.0;
+
+    // Triangle: integral of the fold over a rising half period
+    double halfPeriodIntegral = 0.0;
+
+    // Sine: integral of one rising folded segment, plus warped-segment tables
+    static constexpr int sineTableSize = 512;
+    double segmentIntegral = 0.0;
+    // Fixed size, so rebuilding them when the symmetry moves never allocates
+    using SineTable = std::array<double, sineTableSize + 1>;
+    SineTable sineFirstTable {}, sineSecondTable {}, sineShapeTable {};
+
+    // Tanh: start of the 5% floor and the antiderivatives there
+    static constexpr double ln2 = 0.69314718055994530942;
+    double clipStart = 0.0, clipFirst = 0.0, clipSecond = 0.0;
+
+    //==============================================================================
+    // Triangle fold, constant time. Returns the folded value for a magnitude and whether
+    // it sits on a rising segment of the triangle wave.
+    double triangle(double magnitude, bool& rising) const
+    {
+        if (magnitude <= threshold)
+        {
+            rising = true;
+            return magnitude;
+        }
+
+        const double period = 4.0 * threshold;
+        const double shifted = magnitude + threshold;
+        const double wrapped = shifted - period * std::floor(shifted / period);
+        rising = wrapped < 2.0 * threshold;
+        return threshold - std::abs(wrapped - 2.0 * threshold);
+    }
+
+    // P(o): integral of o * (1 + bias + slope * |o| / T) from 0
+    double trianglePrimitive(double o) const
+    {
+        const double a = std::abs(o);
+        return (1.0 + bias) * 0.5 * o * o + slope * a * a * a / (3.0 * threshold);
+    }
+
+    // R(o): integral of P from 0
+    double triangleSecondPrimitive(double o) const
+    {
+        const double a = std::abs(o);
+        return (1.0 + bias) * o * o * o / 6.0 + slope * o * a * a * a / (12.0 * threshold);
+    }
+
+    //==============================================================================
+    // Position inside a sine fold segment, as in sineFold(): fmod by 2, mirrored
+    static double foldedAmount(double excess)
+    {
+        const double wrapped = excess - 2.0 * std::floor(excess * 0.5);
+        return wrapped > 1.0 ? 2.0 - wrapped : wrapped;
+    }
+
+    static double warpedAmount(double amount, double s)
+    {
+        if (s == 0.0)
+            return amount;
+
+        const double weight = amount < 0.5 ? amount * 2.0 : (1.0 - amount) * 2.0;
+        return amount * (1.0 + s * weight);
+    }
+
+    double sineShape(double amount) const
+    {
+        return std::sin(warpedAmount(amount, symmetry) * juce::MathConstants<double>::halfPi);
+    }
+
+    // Integral and double integral of sineShape over [0, amount], amount in [0, 1]
+    double sineSegmentFirst(double amount) const
+    {
+        if (symmetry == 0.0)
+            return (1.0 - std::cos(amount * juce::MathConstants<double>::halfPi)) / juce::MathConstants<double>::halfPi;
+
+        return interpolateTable(sineFirstTable, sineShapeTable, amount);
+    }
+
+    double sineSegmentSecond(double amount) const
+    {
+        constexpr double k = juce::MathConstants<double>::halfPi;
+
+        if (symmetry == 0.0)
+            return amount / k - std::sin(amount * k) / (k * k);
+
+        return interpolateTable(sineSecondTable, sineFirstTable, amount);
+    }
+
+    // Integral over [0, excess] of the folded sine: whole periods add 2 * segmentIntegral,
+    // the falling half of a period mirrors the rising one
+    double sineFirst(double excess) const
+    {
+        const double periods = std::floor(excess * 0.5);
+        const double r = excess - 2.0 * periods;
+        const double partial = r <= 1.0 ? sineSegmentFirst(r)
+                                         : 2.0 * segmentIntegral - sineSegmentFirst(2.0 - r);
+        return 2.0 * periods * segmentIntegral + partial;
+    }
+
+    // sineFirst() grows linearly at segmentIntegral per unit plus a zero-mean periodic
+    // part, so its integral is a parabola plus the integral of that periodic part
+    double sineSecond(double excess) const
+    {
+        const double periods = std::floor(excess * 0.5);
+        const double r = excess - 2.0 * periods;
+        const double partial = r <= 1.0 ? sineSegmentSecond(r)
+                                         : 2.0 * segmentIntegral * (r - 1.0) + sineSegmentSecond(2.0 - r);
+        return 0.5 * segmentIntegral * (excess * excess - r * r) + partial;
+    }
+
+    // Tables of the warped segment and its two integrals on a uniform grid over [0, 1].
+    // The warp has a kink at 0.5, which is a grid point, so each interval is smooth.
+    void buildSineTables()
+    {
+        const int n = sineTableSize;
+        const double h = 1.0 / n;
+
+        sineShapeTable[0] = 0.0;
+        sineFirstTable[0] = 0.0;
+        sineSecondTable[0] = 0.0;
+
+        for (int i = 0; i < n; ++i)
+        {
+            const double left = sineShape(i * h);
+            const double middle = sineShape((i + 0.5) * h);
+            const double right = sineShape((i + 1) * h);
+
+            // Simpson for the first integral, end-corrected trapezoid for the second
+            sineShapeTable[(size_t) i + 1] = right;
+            sineFirstTable[(size_t) i + 1] = sineFirstTable[(size_t) i] + h / 6.0 * (left + 4.0 * middle + right);
+            sineSecondTable[(size_t) i + 1] = sineSecondTable[(size_t) i]
+                + 0.5 * h * (sineFirstTable[(size_t) i] + sineFirstTable[(size_t) i + 1])
+                + h * h / 12.0 * (left - right);
+        }
+    }
+
+    // Cubic Hermite interpolation, using the table of derivatives alongside the values
+    static double interpolateTable(const SineTable& values, const SineTable& derivatives, double amount)
+    {
+        const int n = sineTableSize;
+        const double position = juce::jlimit(0.0, 1.0, amount) * n;
+        const int i = juce::jmin(n - 1, (int) position);
+        const double t = position - i;
+        const double h = 1.0 / n;
+
+        const double t2 = t * t, t3 = t2 * t;
+        return (2.0 * t3 - 3.0 * t2 + 1.0) * values[(size_t) i]
+             + (t3 - 2.0 * t2 + t) * h * derivatives[(size_t) i]
+             + (-2.0 * t3 + 3.0 * t2) * values[(size_t) i + 1]
+             + (t3 - t2) * h * derivatives[(size_t) i + 1];
+    }
+
+    //==============================================================================
+    double tanhShape(double excess) const
+    {
+        const double t = std::tanh(excess);
+        return std::max(0.05, 1.0 - t * (1.0 + bias + slope * t));
+    }
+
+    // The output hits its 5% floor where (1 + bias) t + slope t^2 = 0.95. If that curve
+    // turns over before t = 1 its peak stays below 0.5, so a crossing only exists when it
+    // rises all the way and ends above 0.95; then there is exactly one.
+    void updateTanhClip()
+    {
+        const double b = 1.0 + bias;
+        const double discriminant = b * b + 3.8 * slope;
+        const bool reachesFloor = b + slope > 0.95 && b + 2.0 * slope >= 0.0;
+
+        if (reachesFloor && discriminant >= 0.0)
+        {
+            const double t = 1.9 / (b + std::sqrt(discriminant));
+            clipStart = t < 1.0 ? std::atanh(t) : std::numeric_limits<double>::max();
+        }
+        else
+        {
+            clipStart = std::numeric_limits<double>::max();
+        }
+
+        if (clipStart < std::numeric_limits<double>::max())
+        {
+            clipFirst = tanhFirstUnclipped(clipStart);
+            clipSecond = tanhSecondUnclipped(clipStart);
+        }
+    }
+
+    // Integral of 1 - (1 + bias) tanh - slope tanh^2 from 0 to x (x >= 0). With
+    // e = exp(-2x), tanh x = (1 - e) / (1 + e) and log cosh x = x + log1p(e) - ln 2.
+    double tanhFirstUnclipped(double x) const
+    {
+        const double e = std::exp(-2.0 * x);
+        const double logCosh = x + std::log1p(e) - ln2;
+        return x - (1.0 + bias) * logCosh - slope * (x - (1.0 - e) / (1.0 + e));
+    }
+
+    double tanhSecondUnclipped(double x) const
+    {
+        const double e = std::exp(-2.0 * x);
+        const double log1pE = std::log1p(e);
+        const double logCosh = x + log1pE - ln2;
+        return 0.5 * x * x - (1.0 + bias) * logCoshIntegral(x, log1pE) - slope * (0.5 * x * x - logCosh);
+    }
+
+    double tanhFirst(double excess) const
+    {
+        if (excess <= clipStart)
+            return tanhFirstUnclipped(excess);
+
+        return clipFirst + 0.05 * (excess - clipStart);
+    }
+
+    double tanhSecond(double excess) const
+    {
+        if (excess <= clipStart)
+            return tanhSecondUnclipped(excess);
+
+        const double d = excess - clipStart;
+        return clipSecond + clipFirst * d + 0.025 * d * d;
+    }
+
+    // Integral of log cosh from 0 to x (x >= 0), given e = exp(-2x) and u = log1p(e):
+    // x^2 / 2 - x ln 2 + (Li2(-e) + pi^2 / 12) / 2. Landen's identity turns Li2(-e) into
+    // -Li2(w) - u^2 / 2 with w = e / (1 + e), and -log(1 - w) is u itself.
+    static double logCoshIntegral(double x, double u)
+    {
+        constexpr double pi = juce::MathConstants<double>::pi;
+        const double dilogarithmOfMinusE = -dilogarithm(u) - 0.5 * u * u;
+        return 0.5 * x * x - x * ln2 + 0.5 * (dilogarithmOfMinusE + pi * pi / 12.0);
+    }
+
+    // Li2(w) for w in [0, 0.5] from u = -log(1 - w), as the Bernoulli series
+    // u - u^2 / 4 + sum B_2k u^(2k+1) / (2k+1)!. Its terms shrink like (u / 2 pi)^2k and
+    // u <= ln 2, so eight terms of a fixed polynomial in u^2 reach double precision,
+    // where the power series in w needs fifty.
+    static double dilogarithm(double u)
+    {
+        constexpr double coefficients[] = {
+            2.77777777777777762e-02, -2.77777777777777778e-04, 4.72411186696900978e-06, -9.18577307466196408e-08,
+            1.89788699889710005e-09, -4.06476164514422560e-11, 8.92169102045645230e-13, -1.99392958607210744e-14
+        };
+
+        const double u2 = u * u;
+        double sum = 0.0;
+
+        for (int k = (int) std::size(coefficients) - 1; k >= 0; --k)
+            sum = sum * u2 + coefficients[k];
+
+        return u - 0.25 * u2 + u * u2 * sum;
+    }
+};
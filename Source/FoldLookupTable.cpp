@@ -0,0 +1,104 @@
+#include "FoldLookupTable.h"
+
+FoldLookupTable::FoldLookupTable(Curve curveToBake)
+    : curve(curveToBake)
+{
+}
+
+FoldLookupTable::~FoldLookupTable()
+{
+    // Blocks until a bake in progress has finished
+    if (isAllocated())
+        bakerThread->removeTimeSliceClient(this);
+}
+
+void FoldLookupTable::allocate()
+{
+    if (isAllocated())
+        return;
+
+    for (auto& table : tables)
+    {
+        table.curve = curve;
+        table.values.resize((size_t) tableSize + 1);
+    }
+
+    // Published before the baker can run, so it only ever sees whole tables
+    allocated.store(true, std::memory_order_release);
+    bakerThread->addTimeSliceClient(this);
+}
+
+const FoldLookupTable::Table* FoldLookupTable::acquire(const Key& key) noexcept
+{
+    if (key != lastRequest)
+    {
+        lastRequest = key;
+
+        const auto version = requestVersion.load(std::memory_order_relaxed);
+        requestVersion.store(version + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        requestedThreshold.store(key.threshold, std::memory_order_relaxed);
+        requestedOffset.store(key.offset, std::memory_order_relaxed);
+        requestedSymmetry.store(key.symmetry, std::memory_order_relaxed);
+        requestedShape.store(key.shape, std::memory_order_relaxed);
+
+        requestVersion.store(version + 2, std::memory_order_release);
+    }
+
+    // The request above stands, so the first bake starts with the current settings
+    if (! isAllocated())
+        return nullptr;
+
+    // Pick up a newly published table, handing our old one back to the baker
+    if ((middle.load(std::memory_order_relaxed) & freshBit) != 0)
+        front = middle.exchange(front, std::memory_order_acq_rel) & ~freshBit;
+
+    const auto& table = tables[(size_t) front];
+    return table.key == key ? &table : nullptr;
+}
+
+bool FoldLookupTable::readRequest(Key& key, juce::uint32& version) const noexcept
+{
+    version = requestVersion.load(std::memory_order_acquire);
+
+    if ((version & 1) != 0)
+        return false;
+
+    key.threshold = requestedThreshold.load(std::memory_order_relaxed);
+    key.offset = requestedOffset.load(std::memory_order_relaxed);
+    key.symmetry = requestedSymmetry.load(std::memory_order_relaxed);
+    key.shape = requestedShape.load(std::memory_order_relaxed);
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return requestVersion.load(std::memory_order_relaxed) == version;
+}
+
+int FoldLookupTable::useTimeSlice()
+{
+    Key key;
+    juce::uint32 version = 0;
+
+    // Torn read: the audio thread is mid-update, so look again straight away
+    if (! readRequest(key, version))
+        return 0;
+
+    if (version == bakedVersion || key.threshold <= 0.0f)
+        return 10;
+
+    auto& table = tables[(size_t) back];
+    const float step = 1.0f / Table::pointsPerUnit;
+
+    for (int i = 0; i <= tableSize; ++i)
+    {
+        const float amplified = -range + (float) i * step;
+        table.values[(size_t) i] = curve(amplified + key.offset, key.threshold, key.symmetry, key.shape) - key.offset;
+    }
+
+    table.key = key;
+    back = middle.exchange(back | freshBit, std::memory_order_acq_rel) & ~freshBit;
+    bakedVersion = version;
+
+    // Settings may have moved again while baking
+    return 0;
+}
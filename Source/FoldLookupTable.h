@@ -0,0 +1,119 @@
+#pragma once
+
+#include <juce_dsp/juce_dsp.h>
+#include <array>
+#include <atomic>
+#include <vector>
+
+// The fold transfer curve baked into an interpolated table on a shared background
+// thread.
+//
+// For a fixed threshold, offset, symmetry and shape the fold is a static curve of the
+// driven input, so the audio thread can replace sin/tanh/fmod with one linear table
+// lookup. acquire() posts the settings it wants; the baker thread picks them up, fills a
+// spare table and publishes it through a lock-free triple buffer. Until a table for the
+// current settings has been published acquire() returns nullptr and the caller folds
+// directly, so parameter moves never wait on the baker.
+//
+// Most wavefolders never use their table, so nothing is allocated and the baker doesn't
+// poll until allocate() is first called; acquire() returns nullptr until then.
+class FoldLookupTable : private juce::TimeSliceClient
+{
+public:
+    // The wavefolder's transfer curve: (input, threshold, symmetry 0..1, shape) -> output
+    using Curve = float (*)(float input, float threshold, float symmetry, float shape);
+
+    struct Key
+    {
+        float threshold = -1.0f;
+        float offset = 0.0f;
+        float symmetry = 0.0f;
+        float shape = 0.0f;
+
+        bool operator==(const Key& other) const noexcept
+        {
+            return threshold == other.threshold && offset == other.offset
+                && symmetry == other.symmetry && shape == other.shape;
+        }
+
+        bool operator!=(const Key& other) const noexcept { return ! (*this == other); }
+    };
+
+    // Driven inputs inside +/- range come from the table; anything beyond is folded directly
+    static constexpr float range = 32.0f;
+    static constexpr int tableSize = 16384;
+
+    class Table
+    {
+    public:
+        // curve(amplified + offset) - offset, for amplified = input * drive
+        float lookup(float amplified) const noexcept
+        {
+            const float position = (amplified + range) * pointsPerUnit;
+
+            if (position < 0.0f || position >= (float) tableSize)
+                return curve(amplified + key.offset, key.threshold, key.symmetry, key.shape) - key.offset;
+
+            const int index = (int) position;
+            const float fraction = position - (float) index;
+            return values[(size_t) index] + fraction * (values[(size_t) index + 1] - values[(size_t) index]);
+        }
+
+        const Key& getKey() const noexcept { return key; }
+
+    private:
+        friend class FoldLookupTable;
+
+        static constexpr float pointsPerUnit = (float) tableSize / (2.0f * range);
+
+        Key key;
+        Curve curve = nullptr;
+        std::vector<float> values;
+    };
+
+    explicit FoldLookupTable(Curve curveToBake);
+    ~FoldLookupTable() override;
+
+    // Allocates the tables and registers with the baker thread, the first time only.
+    // Not on the audio thread, though acquire() may run on it at the same time.
+    void allocate();
+    bool isAllocated() const noexcept { return allocated.load(std::memory_order_acquire); }
+
+    // Audio thread only. Returns the table for these settings once it has been baked,
+    // otherwise asks for it and returns nullptr.
+    const Table* acquire(const Key& key) noexcept;
+
+private:
+    Curve curve;
+    std::atomic<bool> allocated { false };
+
+    // Triple buffer: the audio thread owns `front`, the baker owns `back`, and the third
+    // slot is swapped through `middle`, whose freshBit marks a newly published table
+    static constexpr int freshBit = 4;
+    std::array<Table, 3> tables;
+    std::atomic<int> middle { 1 };
+    int front = 0;
+    int back = 2;
+
+    // Settings requested by the audio thread, published as a seqlock: the version is odd
+    // while the fields are being written
+    std::atomic<float> requestedThreshold { -1.0f }, requestedOffset { 0.0f };
+    std::atomic<float> requestedSymmetry { 0.0f }, requestedShape { 0.0f };
+    std::atomic<juce::uint32> requestVersion { 0 };
+    Key lastRequest;
+    juce::uint32 bakedVersion = 0;
+
+    int useTimeSlice() override;
+    bool readRequest(Key& key, juce::uint32& version) const noexcept;
+
+    // One background thread bakes for every wavefolder in the process
+    struct BakerThread : public juce::TimeSliceThread
+    {
+        BakerThread() : juce::TimeSliceThread("Fold table baker") { startThread(); }
+        ~BakerThread() override { stopThread(1000); }
+    };
+
+    juce::SharedResourcePointer<BakerThread> bakerThread;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(FoldLookupTable)
+};
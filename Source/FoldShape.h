@@ -0,0 +1,25 @@
+#pragma once
+
+#include <juce_dsp/juce_dsp.h>
+
+// Which fold curve the shape parameter selects, and which branch of the symmetry warp is
+// active. Both stay constant for a block, so the fold kernels take them as template
+// arguments and the block code picks the matching specialisation once.
+enum class FoldShape { triangle, sine, tanh };
+enum class SymmetryMode { none, positive, negative };
+
+inline FoldShape getFoldShape(float shape)
+{
+    shape = juce::jlimit(0.0f, 1.0f, shape);
+    return shape < 0.33f ? FoldShape::triangle
+         : shape < 0.66f ? FoldShape::sine
+                         : FoldShape::tanh;
+}
+
+// symmetry is the centred -1..1 value the fold shapes use
+inline SymmetryMode getSymmetryMode(float symmetry)
+{
+    return symmetry > 0.0f ? SymmetryMode::positive
+         : symmetry < 0.0f ? SymmetryMode::negative
+                           : SymmetryMode::none;
+}
@@ -0,0 +1,292 @@
+#include "FrozenReverb.h"
+
+template <typename SampleType>
+FrozenReverb<SampleType>::FrozenReverb(Renderer rendererToUse)
+    : renderer(std::move(rendererToUse))
+{
+}
+
+template <typename SampleType>
+FrozenReverb<SampleType>::~FrozenReverb()
+{
+    // Blocks until a capture in progress has finished
+    captureThread->removeTimeSliceClient(this);
+}
+
+template <typename SampleType>
+void FrozenReverb<SampleType>::prepare(const juce::dsp::ProcessSpec& spec)
+{
+    const juce::ScopedLock sl(captureLock);
+
+    sampleRate = spec.sampleRate;
+    maxBlockSize = (int) spec.maximumBlockSize;
+
+    numChannels = juce::jmax(1, (int) spec.numChannels);
+    numPairs = numChannels / 2;
+
+    // The head's partitions take about a block, which keeps the FFTs it redoes every
+    // block small
+    layout = ConvolutionLayout::forBlockSize(maxBlockSize);
+
+    convolutions.reset();
+    spareConvolutions.reset();
+
+    convolutionInput.setSize(2, maxBlockSize);
+    convolutionOutput.setSize(2, maxBlockSize);
+    output.setSize(numChannels, maxBlockSize);
+    outputSamples = 0;
+
+    // A response captured before was for another rate or layout, so any capture is stale
+    captureState = none;
+    state = idle;
+    stale = true;
+    liveRemaining = 0;
+    convolutionRemaining = 0;
+
+    captureThread->addTimeSliceClient(this);
+}
+
+template <typename SampleType>
+void FrozenReverb<SampleType>::reset() noexcept
+{
+    if (convolutions != nullptr)
+    {
+        for (auto& convolution : convolutions->pairs)
+            convolution->reset();
+
+        if (convolutions->mono != nullptr)
+            convolutions->mono->reset();
+    }
+
+    // Nothing is left to ring out on either side
+    liveRemaining = 0;
+    convolutionRemaining = 0;
+    outputSamples = 0;
+
+    if (state == draining)
+        state = idle;
+}
+
+template <typename SampleType>
+bool FrozenReverb<SampleType>::wantsCapture() const noexcept
+{
+    return wantFrozen && state == idle && maxBlockSize > 0
+        && captureState.load(std::memory_order_relaxed) == none;
+}
+
+template <typename SampleType>
+void FrozenReverb<SampleType>::requestCapture(ImpulseResponseCache::Key settingsKey) noexcept
+{
+    jassert(wantsCapture());
+
+    requestedSettings = settingsKey;
+    stale = false;
+    state = waitingForCapture;
+    captureState.store(requested, std::memory_order_release);
+}
+
+template <typename SampleType>
+void FrozenReverb<SampleType>::process(const juce::dsp::AudioBlock<SampleType>& input) noexcept
+{
+    const int numSamples = (int) input.getNumSamples();
+    const bool keep = wantFrozen && ! stale;
+    outputSamples = 0;
+
+    switch (state)
+    {
+        case idle:
+            // A capture abandoned on the way goes back to the capture thread once it lands
+            if (captureState.load(std::memory_order_acquire) == loaded)
+                captureState.store(none, std::memory_order_release);
+
+            return;
+
+        case waitingForCapture:
+            if (! keep)
+            {
+                state = idle;
+                return;
+            }
+
+            if (captureState.load(std::memory_order_acquire) != loaded)
+                return;
+
+            // Take over with the new convolutions, which start from silence, and hand the
+            // old ones back to be freed. From this block on, the live path only rings out.
+            std::swap(convolutions, spareConvolutions);
+            captureState.store(none, std::memory_order_release);
+            liveRemaining = liveTailSamples;
+            state = active;
+            break;
+
+        case active:
+            liveRemaining = juce::jmax(0, liveRemaining - numSamples);
+
+            if (! keep)
+            {
+                // Hand back: the live path takes the input again, the convolution rings out
+                convolutionRemaining = convolutions->length;
+                state = draining;
+            }
+
+            break;
+
+        case draining:
+            if (keep)
+            {
+                // Settings are back where the response was captured: take over again
+                liveRemaining = liveTailSamples;
+                state = active;
+                break;
+            }
+
+            if (convolutionRemaining <= 0)
+            {
+                state = idle;
+                return;
+            }
+
+            convolutionRemaining -= numSamples;
+            break;
+    }
+
+    convolve(state == active ? &input : nullptr, numSamples);
+    outputSamples = numSamples;
+}
+
+template <typename SampleType>
+void FrozenReverb<SampleType>::convolve(const juce::dsp::AudioBlock<SampleType>* input, int numSamples) noexcept
+{
+    const int numInputChannels = input != nullptr ? (int) input->getNumChannels() : 0;
+    jassert(numSamples <= maxBlockSize && convolutions != nullptr);
+
+    auto run = [&] (PartitionedConvolution& convolution, int firstChannel, int numConvolutionChannels)
+    {
+        for (int side = 0; side < numConvolutionChannels; ++side)
+        {
+            float* samples = convolutionInput.getWritePointer(side);
+
+            if (firstChannel + side >= numInputChannels)
+            {
+                std::fill(samples, samples + numSamples, 0.0f);
+                continue;
+            }
+
+            const SampleType* source = input->getChannelPointer((size_t) (firstChannel + side));
+
+            for (int sample = 0; sample < numSamples; ++sample)
+                samples[sample] = (float) source[sample];
+        }
+
+        const float* inputs[] = { convolutionInput.getReadPointer(0), convolutionInput.getReadPointer(1) };
+        float* outputs[] = { convolutionOutput.getWritePointer(0), convolutionOutput.getWritePointer(1) };
+        convolution.process(inputs, outputs, numSamples);
+
+        for (int side = 0; side < numConvolutionChannels; ++side)
+        {
+            SampleType* destination = output.getWritePointer(firstChannel + side);
+            const float* source = convolutionOutput.getReadPointer(side);
+
+            for (int sample = 0; sample < numSamples; ++sample)
+                destination[sample] = (SampleType) source[sample];
+        }
+    };
+
+    for (int pair = 0; pair < numPairs; ++pair)
+        run(*convolutions->pairs[(size_t) pair], 2 * pair, 2);
+
+    if (convolutions->mono != nullptr)
+        run(*convolutions->mono, 2 * numPairs, 1);
+}
+
+template <typename SampleType>
+void FrozenReverb<SampleType>::addOutput(const juce::dsp::AudioBlock<SampleType>& wet) const noexcept
+{
+    if (outputSamples == 0)
+        return;
+
+    const int numChannels = juce::jmin((int) wet.getNumChannels(), output.getNumChannels());
+    const int numSamples = juce::jmin((int) wet.getNumSamples(), outputSamples);
+
+    for (int channel = 0; channel < numChannels; ++channel)
+        juce::FloatVectorOperations::add(wet.getChannelPointer((size_t) channel), output.getReadPointer(channel), numSamples);
+}
+
+template <typename SampleType>
+int FrozenReverb<SampleType>::useTimeSlice()
+{
+    const auto current = captureState.load(std::memory_order_acquire);
+
+    if (current == none)
+    {
+        // Whatever the audio thread handed back, it won't touch again
+        const juce::ScopedLock sl(captureLock);
+        spareConvolutions.reset();
+        return 20;
+    }
+
+    if (current != requested)
+        return 20;
+
+    const juce::ScopedLock sl(captureLock);
+
+    // prepare() may have cancelled it meanwhile
+    if (captureState.load(std::memory_order_acquire) != requested)
+        return 20;
+
+    spareConvolutions = createConvolutions();
+    captureState.store(loaded, std::memory_order_release);
+    return 20;
+}
+
+template <typename SampleType>
+std::unique_ptr<typename FrozenReverb<SampleType>::Convolutions> FrozenReverb<SampleType>::createConvolutions()
+{
+    const bool withMono = numChannels % 2 != 0;
+
+    // The same settings at the same rate render the same response, so an instance that
+    // finds it in the cache skips the render
+    const double rate = sampleRate;
+    auto sourceKey = ImpulseResponseCache::hash(&rate, sizeof(rate), requestedSettings);
+    sourceKey = ImpulseResponseCache::hash(&withMono, sizeof(withMono), sourceKey);
+
+    auto response = cache->find(sourceKey, layout);
+
+    if (response == nullptr)
+    {
+        ImpulseResponses responses;
+        renderer(responses, sampleRate, withMono);
+
+        // One response holds every path: left to left and right, right to left and
+        // right, then mono
+        const int length = responses.fromLeft.getNumSamples();
+        juce::AudioBuffer<float> paths(withMono ? 5 : 4, length);
+
+        for (int side = 0; side < 2; ++side)
+        {
+            paths.copyFrom(side, 0, responses.fromLeft, side, 0, length);
+            paths.copyFrom(2 + side, 0, responses.fromRight, side, 0, length);
+        }
+
+        if (withMono)
+            paths.copyFrom(4, 0, responses.mono, 0, 0, length);
+
+        response = cache->add(sourceKey, paths, layout);
+    }
+
+    jassert(response->getNumChannels() == (withMono ? 5 : 4));
+
+    auto created = std::make_unique<Convolutions>();
+
+    for (int pair = 0; pair < numPairs; ++pair)
+        created->pairs.push_back(std::make_unique<PartitionedConvolution>(response, 2, 2, 0));
+
+    if (withMono)
+        created->mono = std::make_unique<PartitionedConvolution>(response, 1, 1, 4);
+
+    created->length = response->getLength();
+    return created;
+}
+
+template class FrozenReverb<float>;
+template class FrozenReverb<double>;
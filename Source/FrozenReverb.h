@@ -0,0 +1,168 @@
+#pragma once
+
+#include <juce_dsp/juce_dsp.h>
+#include "ImpulseResponseCache.h"
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
+// The wet path frozen into a convolution, for mixes whose reverb settings are locked.
+//
+// When frozen, the engine's wet path (pre-delay, fold, diffusion, reverb, EQ) is
+// rendered offline on a shared background thread, its impulse response is partitioned
+// for a zero-latency PartitionedConvolution, and the convolution takes over from the
+// live path. Long decays then cost a few FFTs per block instead of the whole
+// algorithmic chain, and the oversampled fold disappears from the audio thread.
+//
+// Accuracy trade-off: a convolution is linear, the fold is not. The response is
+// captured with an impulse at captureLevel (-40 dBFS), where the fold behaves like its
+// small-signal gain, and the render of silence is subtracted so DC from the fold's
+// offset doesn't end up in it. The owner renders in double precision, so the quiet
+// impulse doesn't cost the response any accuracy. The frozen sound matches the live one
+// for quiet material and loses the harmonics the fold adds as the level rises: the
+// harder the drive, the bigger the difference. The engine stays live with the in-loop
+// fold, since the network it folds is not linear even at low level.
+//
+// Each channel pair is captured as true stereo, i.e. both outputs' responses to an
+// impulse in either input, since the input diffusion runs different delays per side.
+// That takes a two-in, two-out convolution per pair.
+//
+// Sharing: the response's spectra come from the process-wide ImpulseResponseCache, so
+// every instance frozen at the same settings convolves with one copy of them, mapped
+// from the cache directory. The cache also remembers which settings rendered which
+// response, so once one instance has captured them, the others skip the render as well
+// and only allocate their own input history.
+//
+// Handover: there's no crossfade as such. From the block the convolution takes over,
+// it gets the input and the live path gets silence. The live path keeps running until
+// everything it already had has rung out, and the two outputs are summed, so the tail
+// carries on seamlessly. Going back works the other way round. A change to any
+// setting the wet path depends on hands back to the live path, lets the convolution
+// ring out, then captures again. The capture builds new convolutions on the capture
+// thread, and the audio thread swaps them in when it takes over; the ones they replace
+// go back to the capture thread to be freed.
+template <typename SampleType>
+class FrozenReverb : private juce::TimeSliceClient
+{
+public:
+    // Level of the captured impulse
+    static constexpr float captureLevel = 0.01f;
+
+    // Longest response captured, however long the tail
+    static constexpr double maxCaptureSeconds = 10.0;
+
+    // Responses of one channel pair, and of an unpaired last channel
+    struct ImpulseResponses
+    {
+        juce::AudioBuffer<float> fromLeft;  // left input to left and right outputs
+        juce::AudioBuffer<float> fromRight; // right input to left and right outputs
+        juce::AudioBuffer<float> mono;      // only when the prepared channel count is odd
+    };
+
+    // Renders the live wet path's responses on the capture thread, at the settings the
+    // owner saved before it called requestCapture(). All of them must have the same
+    // length.
+    using Renderer = std::function<void (ImpulseResponses& responses, double sampleRate, bool withMono)>;
+
+    explicit FrozenReverb(Renderer rendererToUse);
+    ~FrozenReverb() override;
+
+    // Waits for a capture in progress, and drops the captured response
+    void prepare(const juce::dsp::ProcessSpec& spec);
+
+    // Clears the convolution's history; a captured response stays
+    void reset() noexcept;
+
+    //==============================================================================
+    // Audio thread
+
+    void setFrozen(bool shouldBeFrozen) noexcept { wantFrozen = shouldBeFrozen; }
+
+    // A setting the captured response depends on has changed
+    void invalidate() noexcept { stale = true; }
+
+    // How long the live path takes to ring out after its input stops
+    void setLiveTailSamples(int numSamples) noexcept { liveTailSamples = numSamples; }
+
+    // True when a response should be captured now. The owner saves what the renderer
+    // needs, then calls requestCapture() with a hash of it, which names the response in
+    // the cache along with the sample rate and channel count.
+    bool wantsCapture() const noexcept;
+    void requestCapture(ImpulseResponseCache::Key settingsKey) noexcept;
+
+    // Advances the handover and runs the convolution on the wet path's input, before
+    // the live path. Its output is added by addOutput() after the live path.
+    void process(const juce::dsp::AudioBlock<SampleType>& input) noexcept;
+    void addOutput(const juce::dsp::AudioBlock<SampleType>& wet) const noexcept;
+
+    // Whether the live path gets the input, and whether it has to run at all
+    bool isLiveFed() const noexcept { return state != active; }
+    bool isLiveRunning() const noexcept { return isLiveFed() || liveRemaining > 0; }
+
+    // True while the convolution takes the input
+    bool isActive() const noexcept { return state == active; }
+
+private:
+    enum State { idle, waitingForCapture, active, draining };
+
+    // Capture handshake: the audio thread goes from none to requested, the capture
+    // thread from requested to loaded, and the audio thread back to none
+    enum CaptureState { none, requested, loaded };
+
+    Renderer renderer;
+
+    double sampleRate = 44100.0;
+    int maxBlockSize = 0;
+    int numChannels = 0;
+    int numPairs = 0;
+    ConvolutionLayout layout;
+
+    // One response's convolutions: per channel pair, and for an unpaired last channel
+    struct Convolutions
+    {
+        std::vector<std::unique_ptr<PartitionedConvolution>> pairs;
+        std::unique_ptr<PartitionedConvolution> mono;
+        int length = 0;
+    };
+
+    // The audio thread's, and the capture thread's new or retired ones, which change
+    // hands with the capture handshake
+    std::unique_ptr<Convolutions> convolutions, spareConvolutions;
+
+    // The convolutions' float input and output, and every channel's output
+    juce::AudioBuffer<float> convolutionInput, convolutionOutput;
+    juce::AudioBuffer<SampleType> output;
+    int outputSamples = 0;
+
+    // Audio thread
+    State state = idle;
+    bool wantFrozen = false;
+    bool stale = true;
+    int liveTailSamples = 0;
+    int liveRemaining = 0;
+    int convolutionRemaining = 0;
+
+    // Written by the audio thread before it publishes `requested`
+    ImpulseResponseCache::Key requestedSettings = 0;
+    std::atomic<int> captureState { none };
+
+    // Held for a whole capture, and by prepare()
+    juce::CriticalSection captureLock;
+
+    int useTimeSlice() override;
+    std::unique_ptr<Convolutions> createConvolutions();
+    void convolve(const juce::dsp::AudioBlock<SampleType>* input, int numSamples) noexcept;
+
+    juce::SharedResourcePointer<ImpulseResponseCache> cache;
+
+    struct CaptureThread : public juce::TimeSliceThread
+    {
+        CaptureThread() : juce::TimeSliceThread("Reverb capture") { startThread(); }
+        ~CaptureThread() override { stopThread(1000); }
+    };
+
+    juce::SharedResourcePointer<CaptureThread> captureThread;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(FrozenReverb)
+};
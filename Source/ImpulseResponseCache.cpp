@@ -0,0 +1,250 @@
+#include "ImpulseResponseCache.h"
+
+namespace
+{
+    // Cache file: this header, then the spectra as native floats. A file that doesn't
+    // match what it's loaded for in every field, or whose spectra don't hash to the
+    // checksum, is ignored, and replaced once the response has been partitioned again.
+    struct FileHeader
+    {
+        char magic[8];
+        juce::uint32 version;
+        juce::uint32 byteOrder;
+        juce::uint64 key;
+        juce::int32 numChannels;
+        juce::int32 length;
+        juce::int32 headBlockSize;
+        juce::int32 tailBlockSize;
+        juce::uint64 numFloats;
+        juce::uint64 checksum;
+        juce::uint8 reserved[8];
+    };
+
+    // Keeps the mapped spectra as aligned as the page they start on
+    static_assert(sizeof(FileHeader) == 64, "Cache file header must stay 64 bytes");
+
+    constexpr char fileMagic[8] = { 'W', 'F', 'I', 'R', 'S', 'P', 'E', 'C' };
+    constexpr juce::uint32 fileVersion = 2;
+    constexpr juce::uint32 byteOrderMark = 0x01020304;
+    constexpr const char* fileExtension = ".wfir";
+}
+
+ImpulseResponseCache::ImpulseResponseCache()
+    : directory(juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory)
+                    .getChildFile("WavefoldReverb").getChildFile("IR cache"))
+{
+}
+
+ImpulseResponseCache::Key ImpulseResponseCache::hash(const void* data, size_t numBytes, Key seed) noexcept
+{
+    const auto* bytes = static_cast<const juce::uint8*>(data);
+
+    for (size_t i = 0; i < numBytes; ++i)
+    {
+        seed ^= bytes[i];
+        seed *= 0x100000001b3ull;
+    }
+
+    return seed;
+}
+
+ImpulseResponseCache::Key ImpulseResponseCache::hashResponse(const juce::AudioBuffer<float>& response) noexcept
+{
+    const juce::int32 shape[] = { response.getNumChannels(), response.getNumSamples() };
+    Key key = hash(shape, sizeof(shape));
+
+    for (int channel = 0; channel < response.getNumChannels(); ++channel)
+        key = hash(response.getReadPointer(channel), sizeof(float) * (size_t) response.getNumSamples(), key);
+
+    return key;
+}
+
+std::shared_ptr<const PartitionedResponse> ImpulseResponseCache::find(Key sourceKey, const ConvolutionLayout& layout)
+{
+    const juce::ScopedLock sl(lock);
+    const auto source = sources.find(sourceKey);
+
+    if (source == sources.end())
+        return {};
+
+    return acquire(source->second, layout, nullptr);
+}
+
+std::shared_ptr<const PartitionedResponse> ImpulseResponseCache::get(const juce::AudioBuffer<float>& response, const ConvolutionLayout& layout)
+{
+    return acquire(hashResponse(response), layout, &response);
+}
+
+std::shared_ptr<const PartitionedResponse> ImpulseResponseCache::add(Key sourceKey, const juce::AudioBuffer<float>& response,
+                                                                     const ConvolutionLayout& layout)
+{
+    const Key responseKey = hashResponse(response);
+    auto shared = acquire(responseKey, layout, &response);
+
+    const juce::ScopedLock sl(lock);
+    sources[sourceKey] = responseKey;
+    return shared;
+}
+
+void ImpulseResponseCache::setDirectory(const juce::File& newDirectory)
+{
+    const juce::ScopedLock sl(lock);
+    directory = newDirectory;
+}
+
+juce::File ImpulseResponseCache::getDirectory() const
+{
+    const juce::ScopedLock sl(lock);
+    return directory;
+}
+
+std::shared_ptr<const PartitionedResponse> ImpulseResponseCache::acquire(Key responseKey, const ConvolutionLayout& layout,
+                                                                         const juce::AudioBuffer<float>* response)
+{
+    const juce::ScopedLock sl(lock);
+
+    // Forget the entries whose last user has gone
+    for (auto entry = entries.begin(); entry != entries.end();)
+        entry = entry->second.expired() ? entries.erase(entry) : std::next(entry);
+
+    const Key entryKey = getEntryKey(responseKey, layout);
+
+    if (auto shared = entries[entryKey].lock())
+        return shared;
+
+    const auto file = getFile(entryKey);
+    auto shared = load(file, entryKey, layout);
+    bool saved = false;
+
+    if (shared == nullptr && response != nullptr)
+    {
+        auto partitioned = std::make_shared<const PartitionedResponse>(*response, layout);
+
+        // Once saved, the mapped file stands in for the heap copy
+        saved = save(file, entryKey, *partitioned);
+
+        if (saved)
+            shared = load(file, entryKey, layout);
+
+        if (shared == nullptr)
+            shared = std::move(partitioned);
+    }
+
+    entries[entryKey] = shared;
+
+    if (saved)
+        trimDirectory();
+
+    return shared;
+}
+
+ImpulseResponseCache::Key ImpulseResponseCache::getEntryKey(Key responseKey, const ConvolutionLayout& layout) noexcept
+{
+    const juce::int32 sizes[] = { layout.headBlockSize, layout.tailBlockSize };
+    return hash(sizes, sizeof(sizes), responseKey);
+}
+
+juce::File ImpulseResponseCache::getFile(Key entryKey) const
+{
+    return directory.getChildFile(juce::String::toHexString((juce::int64) entryKey).paddedLeft('0', 16) + fileExtension);
+}
+
+std::shared_ptr<const PartitionedResponse> ImpulseResponseCache::load(const juce::File& file, Key entryKey, const ConvolutionLayout& layout)
+{
+    if (! file.existsAsFile())
+        return {};
+
+    auto mapped = std::make_shared<juce::MemoryMappedFile>(file, juce::MemoryMappedFile::readOnly);
+
+    if (mapped->getData() == nullptr || mapped->getSize() < sizeof(FileHeader))
+        return {};
+
+    FileHeader header;
+    std::memcpy(&header, mapped->getData(), sizeof(header));
+
+    const bool matches = std::memcmp(header.magic, fileMagic, sizeof(fileMagic)) == 0
+                      && header.version == fileVersion
+                      && header.byteOrder == byteOrderMark
+                      && header.key == entryKey
+                      && header.headBlockSize == layout.headBlockSize
+                      && header.tailBlockSize == layout.tailBlockSize
+                      && header.numChannels > 0 && header.length > 0
+                      && header.numFloats == PartitionedResponse::getNumFloats(layout, header.numChannels, header.length)
+                      && mapped->getSize() == sizeof(FileHeader) + header.numFloats * sizeof(float);
+
+    if (! matches)
+        return {};
+
+    // Catches a file that was truncated, corrupted or written by something else
+    const auto* spectra = reinterpret_cast<const float*>(static_cast<const char*>(mapped->getData()) + sizeof(FileHeader));
+
+    if (hash(spectra, header.numFloats * sizeof(float)) != header.checksum)
+        return {};
+
+    // Marks it as recently used, for trimDirectory()
+    file.setLastModificationTime(juce::Time::getCurrentTime());
+
+    return std::make_shared<const PartitionedResponse>(layout, (int) header.numChannels, (int) header.length, spectra, std::move(mapped));
+}
+
+bool ImpulseResponseCache::save(const juce::File& file, Key entryKey, const PartitionedResponse& response)
+{
+    if (! file.getParentDirectory().createDirectory().wasOk())
+        return false;
+
+    FileHeader header {};
+    std::memcpy(header.magic, fileMagic, sizeof(fileMagic));
+    header.version = fileVersion;
+    header.byteOrder = byteOrderMark;
+    header.key = entryKey;
+    header.numChannels = response.getNumChannels();
+    header.length = response.getLength();
+    header.headBlockSize = response.getLayout().headBlockSize;
+    header.tailBlockSize = response.getLayout().tailBlockSize;
+    header.numFloats = response.getNumFloats();
+    header.checksum = hash(response.getData(), response.getNumFloats() * sizeof(float));
+
+    juce::TemporaryFile temporary(file);
+
+    {
+        juce::FileOutputStream stream(temporary.getFile());
+
+        if (! stream.openedOk())
+            return false;
+
+        const bool written = stream.write(&header, sizeof(header))
+                          && stream.write(response.getData(), response.getNumFloats() * sizeof(float));
+        stream.flush();
+
+        if (! written || stream.getStatus().failed())
+            return false;
+    }
+
+    // Moved into place whole, so no process ever maps a half-written file
+    return temporary.overwriteTargetFileWithTemporary();
+}
+
+void ImpulseResponseCache::trimDirectory() const
+{
+    auto files = directory.findChildFiles(juce::File::findFiles, false, juce::String("*") + fileExtension);
+
+    std::sort(files.begin(), files.end(), [] (const juce::File& a, const juce::File& b)
+    {
+        return a.getLastModificationTime() > b.getLastModificationTime();
+    });
+
+    juce::int64 totalBytes = 0;
+
+    for (const auto& file : files)
+    {
+        const auto size = file.getSize();
+        const auto entry = entries.find((Key) file.getFileNameWithoutExtension().getHexValue64());
+        const bool inUse = entry != entries.end() && ! entry->second.expired();
+
+        // Keeps the most recently used entries that fit, and every one still in use
+        if (totalBytes + size > maxDirectoryBytes && ! inUse && file.deleteFile())
+            continue;
+
+        totalBytes += size;
+    }
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "PartitionedConvolution.h"
+#include <map>
+#include <memory>
+
+// Process-wide store of partitioned impulse responses, so every instance convolving the
+// same response shares one copy of its spectra. Hold it through a
+// juce::SharedResourcePointer.
+//
+// Entries are keyed by a hash of the response's samples and the partition layout, and
+// reference counted: an entry lives as long as someone holds the pointer get() handed
+// out, and a later request finds it while it does. Each entry is also saved to a
+// per-user cache directory in a format that maps straight back into memory, with a
+// checksum of its spectra that's verified on load, and used from the mapping rather
+// than the heap. The spectra then sit in the page cache, shared with any other
+// process mapping the same file (e.g. hosts that run each plugin in its own process),
+// and a later session skips the partitioning.
+//
+// Renders are usually more expensive than partitioning, so callers that make their
+// responses from settings can also name the settings: once a response has been added for
+// a source key, find() returns it without rendering. That mapping only lasts as long as
+// the process, since the same settings may render differently in another build.
+class ImpulseResponseCache
+{
+public:
+    using Key = juce::uint64;
+
+    ImpulseResponseCache();
+
+    // 64-bit FNV-1a, carrying on from seed
+    static constexpr Key initialHash = 0xcbf29ce484222325ull;
+    static Key hash(const void* data, size_t numBytes, Key seed = initialHash) noexcept;
+
+    // Hash of the channel count, length and samples
+    static Key hashResponse(const juce::AudioBuffer<float>& response) noexcept;
+
+    //==============================================================================
+    // Background threads only: these may read, partition and write a whole response
+
+    // The spectra of the response last added for this source key, or nullptr
+    std::shared_ptr<const PartitionedResponse> find(Key sourceKey, const ConvolutionLayout& layout);
+
+    // The response's spectra in this layout, from the first of: an entry still in use in
+    // the process, the cache directory, or partitioning it now (and saving it there)
+    std::shared_ptr<const PartitionedResponse> get(const juce::AudioBuffer<float>& response, const ConvolutionLayout& layout);
+
+    // Same, and remembers the response as the one for sourceKey
+    std::shared_ptr<const PartitionedResponse> add(Key sourceKey, const juce::AudioBuffer<float>& response, const ConvolutionLayout& layout);
+
+    // Where entries are saved; by default a folder in the user's application data
+    // directory, so no other account can plant or read entries
+    void setDirectory(const juce::File& newDirectory);
+    juce::File getDirectory() const;
+
+    // Saving an entry trims the directory back to this, least recently used first
+    static constexpr juce::int64 maxDirectoryBytes = (juce::int64) 512 << 20;
+
+private:
+    juce::CriticalSection lock;
+    juce::File directory;
+    std::map<Key, std::weak_ptr<const PartitionedResponse>> entries;
+    std::map<Key, Key> sources;
+
+    std::shared_ptr<const PartitionedResponse> acquire(Key responseKey, const ConvolutionLayout& layout,
+                                                       const juce::AudioBuffer<float>* response);
+    static Key getEntryKey(Key responseKey, const ConvolutionLayout& layout) noexcept;
+    juce::File getFile(Key entryKey) const;
+    static std::shared_ptr<const PartitionedResponse> load(const juce::File& file, Key entryKey, const ConvolutionLayout& layout);
+    static bool save(const juce::File& file, Key entryKey, const PartitionedResponse& response);
+    void trimDirectory() const;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ImpulseResponseCache)
+};
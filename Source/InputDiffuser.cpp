@@ -0,0 +1,272 @@
+#include "InputDiffuser.h"
+
+namespace
+{
+    constexpr double shortestStageSeconds = 0.0035;
+    constexpr double longestStageSeconds = 0.0125;
+
+    // Extra delay on the odd channel of each pair (23 samples at 44.1 kHz, as Freeverb)
+    constexpr double stereoSpreadSeconds = 23.0 / 44100.0;
+}
+
+template <typename SampleType>
+void InputDiffuser<SampleType>::prepare(const juce::dsp::ProcessSpec& spec)
+{
+    sampleRate = spec.sampleRate;
+    numChannelsPrepared = juce::jmax(1, (int) spec.numChannels);
+
+    const int spread = juce::roundToInt(stereoSpreadSeconds * sampleRate);
+    capacity = 0;
+
+    for (int tier = 1; tier < numTiers; ++tier)
+    {
+        const int stagesInTier = getNumStages(tier);
+
+        for (int side = 0; side < 2; ++side)
+        {
+            int previous = 0;
+
+            // Mutually prime lengths keep the stages' echoes from lining up
+            for (int stage = 0; stage < stagesInTier; ++stage)
+            {
+                const double position = (double) stage / (double) (stagesInTier - 1);
+                const double seconds = shortestStageSeconds * std::pow(longestStageSeconds / shortestStageSeconds, position);
+                const int length = nextPrime(juce::jmax(previous + 1, juce::roundToInt(seconds * sampleRate) + side * spread));
+
+                tierDelays[(size_t) tier][(size_t) side][(size_t) stage] = length;
+                capacity = juce::jmax(capacity, length);
+                previous = length;
+            }
+        }
+    }
+
+    const int numBuffers = 2 * numChannelsPrepared * maxStages;
+    storage.calloc((size_t) (numBuffers * capacity));
+
+    for (int bankIndex = 0; bankIndex < 2; ++bankIndex)
+    {
+        auto& bank = banks[(size_t) bankIndex];
+        bank.chains.assign((size_t) numChannelsPrepared, Chain {});
+        bank.tier = -1;
+
+        for (int channel = 0; channel < numChannelsPrepared; ++channel)
+            for (int stage = 0; stage < maxStages; ++stage)
+                bank.chains[(size_t) channel][(size_t) stage].data
+                    = storage.getData() + ((bankIndex * numChannelsPrepared + channel) * maxStages + stage) * capacity;
+    }
+
+    fadeBufferSize = juce::jmax(1, (int) spec.maximumBlockSize);
+    fadeBuffer.allocate((size_t) fadeBufferSize, false);
+    fadeLength = juce::jmax(1, juce::roundToInt(fadeSeconds * sampleRate));
+
+    // Fit the chains to the current tier's delays, with nothing to fade from
+    targetTier = getTier(currentDensity);
+    reset();
+}
+
+template <typename SampleType>
+void InputDiffuser<SampleType>::reset()
+{
+    // Everything's silent now, so the pending tier can take over without a fade
+    fadeRemaining = 0;
+
+    for (auto& bank : banks)
+        clearBank(bank);
+
+    if (targetTier >= 0 && banks[(size_t) activeBank].tier != targetTier)
+        setBankTier(banks[(size_t) activeBank], targetTier);
+}
+
+template <typename SampleType>
+void InputDiffuser<SampleType>::clearBank(Bank& bank) noexcept
+{
+    for (auto& chain : bank.chains)
+    {
+        for (auto& stage : chain)
+        {
+            if (stage.data != nullptr)
+                std::fill(stage.data, stage.data + capacity, SampleType (0));
+
+            stage.index = 0;
+        }
+    }
+}
+
+template <typename SampleType>
+void InputDiffuser<SampleType>::setBankTier(Bank& bank, int tier) noexcept
+{
+    bank.tier = tier;
+    bank.numStages = getNumStages(tier);
+
+    for (int channel = 0; channel < (int) bank.chains.size(); ++channel)
+        for (int stage = 0; stage < maxStages; ++stage)
+            bank.chains[(size_t) channel][(size_t) stage].size = tierDelays[(size_t) tier][(size_t) (channel & 1)][(size_t) stage];
+
+    clearBank(bank);
+}
+
+template <typename SampleType>
+int InputDiffuser<SampleType>::getTier(float density) noexcept
+{
+    return juce::jlimit(0, numTiers - 1, juce::roundToInt(density * (float) (numTiers - 1)));
+}
+
+template <typename SampleType>
+void InputDiffuser<SampleType>::setDensity(float newDensity)
+{
+    currentDensity = newDensity;
+    targetTier = getTier(currentDensity);
+
+    // Mid-fade, process() picks the new tier up once the fade is done; unprepared,
+    // prepare() does
+    if (fadeRemaining == 0 && banks[(size_t) activeBank].tier >= 0 && banks[(size_t) activeBank].tier != targetTier)
+        startFade();
+}
+
+template <typename SampleType>
+void InputDiffuser<SampleType>::startFade() noexcept
+{
+    // The idle bank has been silent since the last fade finished, so clearing it drops
+    // nothing that's heard; the active bank keeps its rings and fades out
+    activeBank = 1 - activeBank;
+    setBankTier(banks[(size_t) activeBank], targetTier);
+    fadeRemaining = fadeLength;
+}
+
+template <typename SampleType>
+double InputDiffuser<SampleType>::getTailLengthSeconds(float density, double decibels)
+{
+    const int stagesInChain = getNumStages(getTier(density));
+    double seconds = 0.0;
+
+    for (int stage = 0; stage < stagesInChain; ++stage)
+    {
+        // Each pass round a stage's loop loses -20 log10(gain) dB; the odd channel's
+        // spread makes its stages the longer ones
+        const double position = stagesInChain > 1 ? (double) stage / (double) (stagesInChain - 1) : 0.0;
+        const double delaySeconds = shortestStageSeconds * std::pow(longestStageSeconds / shortestStageSeconds, position)
+                                  + stereoSpreadSeconds;
+        const double decibelsPerPass = -20.0 * std::log10((double) getStageGain(stage, stagesInChain));
+        seconds += delaySeconds * (1.0 + decibels / decibelsPerPass);
+    }
+
+    return seconds;
+}
+
+template <typename SampleType>
+SampleType InputDiffuser<SampleType>::getStageGain(int stage, int stagesInChain) noexcept
+{
+    return 2 * stage < stagesInChain ? (SampleType) 0.75 : (SampleType) 0.625;
+}
+
+template <typename SampleType>
+int InputDiffuser<SampleType>::nextPrime(int value)
+{
+    for (value = juce::jmax(2, value);; ++value)
+    {
+        bool isPrime = true;
+
+        for (int divisor = 2; divisor * divisor <= value && isPrime; ++divisor)
+            isPrime = value % divisor != 0;
+
+        if (isPrime)
+            return value;
+    }
+}
+
+template <typename SampleType>
+void InputDiffuser<SampleType>::process(const juce::dsp::AudioBlock<SampleType>& block) noexcept
+{
+    auto& active = banks[(size_t) activeBank];
+    auto& faded = banks[(size_t) (1 - activeBank)];
+    const int numChannels = juce::jmin((int) block.getNumChannels(), (int) active.chains.size());
+    const int numSamples = (int) block.getNumSamples();
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        SampleType* samples = block.getChannelPointer((size_t) channel);
+
+        if (fadeRemaining == 0)
+        {
+            processBank(active, channel, samples, numSamples);
+            continue;
+        }
+
+        // Both banks run on the input; the old one's share falls linearly to nothing
+        int remaining = fadeRemaining;
+
+        for (int done = 0; done < numSamples;)
+        {
+            const int run = juce::jmin(numSamples - done, fadeBufferSize);
+            SampleType* segment = samples + done;
+
+            std::copy(segment, segment + run, fadeBuffer.getData());
+            processBank(faded, channel, fadeBuffer.getData(), run);
+            processBank(active, channel, segment, run);
+
+            for (int t = 0; t < run && remaining > 0; ++t, --remaining)
+            {
+                const SampleType oldGain = (SampleType) remaining / (SampleType) fadeLength;
+                segment[t] += oldGain * (fadeBuffer[t] - segment[t]);
+            }
+
+            done += run;
+        }
+    }
+
+    if (fadeRemaining > 0)
+    {
+        fadeRemaining = juce::jmax(0, fadeRemaining - numSamples);
+
+        // A density change that came in during the fade
+        if (fadeRemaining == 0 && active.tier != targetTier)
+            startFade();
+    }
+}
+
+template <typename SampleType>
+void InputDiffuser<SampleType>::processBank(Bank& bank, int channel, SampleType* samples, int numSamples) noexcept
+{
+    auto& chain = bank.chains[(size_t) channel];
+
+    switch (bank.numStages)
+    {
+        case 2:  processChain<2>(chain, samples, numSamples); break;
+        case 4:  processChain<4>(chain, samples, numSamples); break;
+        case 6:  processChain<6>(chain, samples, numSamples); break;
+        case 8:  processChain<8>(chain, samples, numSamples); break;
+        default: break; // lowest tier: no diffusion
+    }
+}
+
+template <typename SampleType>
+void InputDiffuser<SampleType>::processStage(DelayBuffer& stage, SampleType gain, SampleType* samples, int numSamples) noexcept
+{
+    // v[n] = x[n] + g v[n - D], y[n] = v[n - D] - g v[n]. Every sample reads its ring slot
+    // before overwriting it, so a run up to the wrap has no dependencies and vectorises.
+    for (int done = 0; done < numSamples;)
+    {
+        const int run = juce::jmin(numSamples - done, stage.size - stage.index);
+        SampleType* buffer = stage.data + stage.index;
+        SampleType* block = samples + done;
+
+        for (int t = 0; t < run; ++t)
+        {
+            const SampleType delayed = buffer[t];
+            SampleType stored = block[t] + gain * delayed;
+            JUCE_UNDENORMALISE(stored);
+            buffer[t] = stored;
+            block[t] = delayed - gain * stored;
+        }
+
+        stage.index += run;
+
+        if (stage.index >= stage.size)
+            stage.index = 0;
+
+        done += run;
+    }
+}
+
+template class InputDiffuser<float>;
+template class InputDiffuser<double>;
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <juce_dsp/juce_dsp.h>
+#include <array>
+#include <utility>
+
+// Series Schroeder allpasses that smear the reverb's input into a dense cloud before
+// it reaches the combs or the delay network, so transients don't ring out as discrete
+// echoes.
+//
+// The density parameter picks a tier, and each tier is a fixed number of stages:
+// none, 2, 4, 6 or 8. Their delays are mutually prime and spread geometrically between
+// shortestStageSeconds and longestStageSeconds, so higher tiers space them more
+// closely as well as adding more. The odd channel of each pair runs slightly longer
+// delays, to decorrelate it from the even one. Gains follow Dattorro's input
+// diffusers: 0.75 for the first half of the chain, 0.625 for the rest.
+//
+// The stage count is a template argument of the chain, so each tier's loop over its
+// stages is unrolled at compile time, and each stage runs over the whole block in
+// contiguous runs up to its ring's wrap. Every tier's delays are worked out in
+// prepare(). Density is a continuous, automatable parameter, so moving to another
+// tier never clears a ring that's being heard. There are two banks of chains: the new
+// tier starts from silence in the idle bank, and the output crossfades into it over
+// fadeSeconds while the old bank keeps running on its own rings.
+template <typename SampleType>
+class InputDiffuser
+{
+public:
+    static constexpr int numTiers = 5;
+    static constexpr int maxStages = 2 * (numTiers - 1);
+
+    // Length of the crossfade between tiers
+    static constexpr double fadeSeconds = 0.02;
+
+    InputDiffuser() = default;
+    ~InputDiffuser() = default;
+
+    void prepare(const juce::dsp::ProcessSpec& spec);
+    void reset();
+
+    // Tier for a density parameter value in [0, 1]
+    static int getTier(float density) noexcept;
+    static int getNumStages(int tier) noexcept { return 2 * juce::jlimit(0, numTiers - 1, tier); }
+
+    // Starts a crossfade to the density's tier, or queues it behind one in progress
+    void setDensity(float newDensity);
+    int getNumStages() const noexcept { return banks[(size_t) activeBank].numStages; }
+
+    // Time for an impulse through this density's chain to fall by `decibels`, bounded
+    // by the sum of every stage's own ring-out
+    static double getTailLengthSeconds(float density, double decibels);
+
+    // In place, on at most the prepared number of channels
+    void process(const juce::dsp::AudioBlock<SampleType>& block) noexcept;
+
+private:
+    struct DelayBuffer
+    {
+        SampleType* data = nullptr;
+        int size = 0;
+        int index = 0;
+    };
+
+    using Chain = std::array<DelayBuffer, maxStages>;
+
+    // One chain per channel, all at one tier
+    struct Bank
+    {
+        std::vector<Chain> chains;
+        int tier = -1;
+        int numStages = 0;
+    };
+
+    double sampleRate = 44100.0;
+    float currentDensity = 0.5f;
+    int numChannelsPrepared = 0;
+    int capacity = 0;
+
+    // The bank being faded in (or the only one heard), and the fade's progress; the
+    // other bank is faded out while fadeRemaining > 0
+    std::array<Bank, 2> banks;
+    int activeBank = 0;
+    int fadeLength = 0;
+    int fadeRemaining = 0;
+    int targetTier = -1;
+
+    // Delay lengths of every tier, for the even and odd channel of a pair
+    std::array<std::array<std::array<int, maxStages>, 2>, numTiers> tierDelays {};
+
+    juce::HeapBlock<SampleType> storage;
+
+    // The faded-out bank's output for one channel
+    juce::HeapBlock<SampleType> fadeBuffer;
+    int fadeBufferSize = 0;
+
+    static SampleType getStageGain(int stage, int stagesInChain) noexcept;
+    static int nextPrime(int value);
+
+    // Points the bank's chains at the tier's delays and clears them
+    void setBankTier(Bank& bank, int tier) noexcept;
+    void clearBank(Bank& bank) noexcept;
+    void startFade() noexcept;
+    void processBank(Bank& bank, int channel, SampleType* samples, int numSamples) noexcept;
+
+    template <int stagesInChain>
+    void processChain(Chain& chain, SampleType* samples, int numSamples) noexcept
+    {
+        processStages(chain, samples, numSamples, std::make_integer_sequence<int, stagesInChain>());
+    }
+
+    template <int... stages>
+    static void processStages(Chain& chain, SampleType* samples, int numSamples, std::integer_sequence<int, stages...>) noexcept
+    {
+        (processStage(chain[(size_t) stages], getStageGain(stages, (int) sizeof... (stages)), samples, numSamples), ...);
+    }
+
+    static void processStage(DelayBuffer& stage, SampleType gain, SampleType* samples, int numSamples) noexcept;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(InputDiffuser)
+};
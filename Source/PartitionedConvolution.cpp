@@ -0,0 +1,347 @@
+#include "PartitionedConvolution.h"
+
+namespace
+{
+    // Each partition is transformed zero-padded to twice its length
+    int getFFTOrder(int blockSize) noexcept
+    {
+        return juce::roundToInt(std::log2((double) (2 * blockSize)));
+    }
+
+    int getSpectrumSize(int blockSize) noexcept
+    {
+        return 2 * (blockSize + 1);
+    }
+
+    // sum += a * b over interleaved complex bins
+    void multiplyAccumulate(const float* a, const float* b, float* sum, int numBins) noexcept
+    {
+        for (int bin = 0; bin < numBins; ++bin)
+        {
+            const float ar = a[2 * bin], ai = a[2 * bin + 1];
+            const float br = b[2 * bin], bi = b[2 * bin + 1];
+            sum[2 * bin] += ar * br - ai * bi;
+            sum[2 * bin + 1] += ar * bi + ai * br;
+        }
+    }
+
+    // Spectra of samples [start, end) in partitions of blockSize, written one after another
+    float* transformPartitions(const float* samples, int start, int end, int blockSize, float* destination)
+    {
+        juce::dsp::FFT fft(getFFTOrder(blockSize));
+        std::vector<float> buffer((size_t) (4 * blockSize));
+        const int spectrumSize = getSpectrumSize(blockSize);
+
+        for (int partitionStart = start; partitionStart < end; partitionStart += blockSize)
+        {
+            std::fill(buffer.begin(), buffer.end(), 0.0f);
+            std::copy(samples + partitionStart, samples + juce::jmin(end, partitionStart + blockSize), buffer.begin());
+            fft.performRealOnlyForwardTransform(buffer.data(), true);
+            std::copy(buffer.begin(), buffer.begin() + spectrumSize, destination);
+            destination += spectrumSize;
+        }
+
+        return destination;
+    }
+}
+
+ConvolutionLayout ConvolutionLayout::forBlockSize(int maximumBlockSize) noexcept
+{
+    const int headBlockSize = juce::jlimit(64, 1024, juce::nextPowerOfTwo(maximumBlockSize));
+    return { headBlockSize, 8 * headBlockSize };
+}
+
+//==============================================================================
+PartitionedResponse::PartitionedResponse(const juce::AudioBuffer<float>& response, const ConvolutionLayout& layoutToUse)
+    : layout(layoutToUse),
+      numChannels(response.getNumChannels()),
+      length(response.getNumSamples())
+{
+    jassert(layout.headBlockSize > 0 && layout.tailBlockSize % layout.headBlockSize == 0);
+
+    ownedSpectra.resize(getNumFloats(layout, numChannels, length));
+    spectra = ownedSpectra.data();
+
+    const int headLength = juce::jmin(length, layout.tailBlockSize);
+    float* destination = ownedSpectra.data();
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        const float* samples = response.getReadPointer(channel);
+        destination = transformPartitions(samples, 0, headLength, layout.headBlockSize, destination);
+        destination = transformPartitions(samples, headLength, length, layout.tailBlockSize, destination);
+    }
+
+    jassert(destination == ownedSpectra.data() + ownedSpectra.size());
+}
+
+PartitionedResponse::PartitionedResponse(const ConvolutionLayout& layoutToUse, int numChannelsIn, int lengthIn,
+                                         const float* spectraIn, std::shared_ptr<const void> storageIn)
+    : layout(layoutToUse),
+      numChannels(numChannelsIn),
+      length(lengthIn),
+      spectra(spectraIn),
+      storage(std::move(storageIn))
+{
+}
+
+int PartitionedResponse::getNumHeadPartitions(const ConvolutionLayout& layout, int length) noexcept
+{
+    const int headLength = juce::jmin(length, layout.tailBlockSize);
+    return (headLength + layout.headBlockSize - 1) / layout.headBlockSize;
+}
+
+int PartitionedResponse::getNumTailPartitions(const ConvolutionLayout& layout, int length) noexcept
+{
+    const int tailLength = juce::jmax(0, length - layout.tailBlockSize);
+    return (tailLength + layout.tailBlockSize - 1) / layout.tailBlockSize;
+}
+
+size_t PartitionedResponse::getNumFloats(const ConvolutionLayout& layout, int numChannels, int length) noexcept
+{
+    const size_t perChannel = (size_t) getNumHeadPartitions(layout, length) * (size_t) getSpectrumSize(layout.headBlockSize)
+                            + (size_t) getNumTailPartitions(layout, length) * (size_t) getSpectrumSize(layout.tailBlockSize);
+    return perChannel * (size_t) numChannels;
+}
+
+const float* PartitionedResponse::getHeadPartition(int channel, int partition) const noexcept
+{
+    const size_t perChannel = getNumFloats(layout, 1, length);
+    return spectra + (size_t) channel * perChannel + (size_t) partition * (size_t) getSpectrumSize(layout.headBlockSize);
+}
+
+const float* PartitionedResponse::getTailPartition(int channel, int partition) const noexcept
+{
+    const size_t perChannel = getNumFloats(layout, 1, length);
+    const size_t headFloats = (size_t) getNumHeadPartitions(layout, length) * (size_t) getSpectrumSize(layout.headBlockSize);
+    return spectra + (size_t) channel * perChannel + headFloats + (size_t) partition * (size_t) getSpectrumSize(layout.tailBlockSize);
+}
+
+//==============================================================================
+void PartitionedConvolution::Level::prepare(int blockSizeToUse, int numPartitionsToUse, int numInputs, int numOutputs)
+{
+    blockSize = blockSizeToUse;
+    numPartitions = numPartitionsToUse;
+    spectrumSize = getSpectrumSize(blockSize);
+
+    if (numPartitions == 0)
+        return;
+
+    fft = std::make_unique<juce::dsp::FFT>(getFFTOrder(blockSize));
+    inputBlocks.resize((size_t) (numInputs * blockSize));
+    inputSpectra.resize((size_t) numInputs * (size_t) numPartitions * (size_t) spectrumSize);
+    overlap.resize((size_t) (numOutputs * blockSize));
+}
+
+void PartitionedConvolution::Level::reset() noexcept
+{
+    std::fill(inputBlocks.begin(), inputBlocks.end(), 0.0f);
+    std::fill(inputSpectra.begin(), inputSpectra.end(), 0.0f);
+    std::fill(overlap.begin(), overlap.end(), 0.0f);
+    newest = 0;
+    position = 0;
+}
+
+float* PartitionedConvolution::Level::getInputSpectrum(int input, int age) noexcept
+{
+    const int slot = (newest - age + numPartitions) % numPartitions;
+    return inputSpectra.data() + ((size_t) input * (size_t) numPartitions + (size_t) slot) * (size_t) spectrumSize;
+}
+
+//==============================================================================
+PartitionedConvolution::PartitionedConvolution(std::shared_ptr<const PartitionedResponse> responseToUse,
+                                               int numInputsToUse, int numOutputsToUse, int firstChannelToUse)
+    : response(std::move(responseToUse)),
+      numInputs(numInputsToUse),
+      numOutputs(numOutputsToUse),
+      firstChannel(firstChannelToUse)
+{
+    jassert(response != nullptr && getChannel(numInputs - 1, numOutputs - 1) < response->getNumChannels());
+
+    const auto& layout = response->getLayout();
+    const int length = response->getLength();
+
+    head.prepare(layout.headBlockSize, PartitionedResponse::getNumHeadPartitions(layout, length), numInputs, numOutputs);
+    tail.prepare(layout.tailBlockSize, PartitionedResponse::getNumTailPartitions(layout, length), numInputs, numOutputs);
+
+    headAccumulators.resize((size_t) (numOutputs * head.spectrumSize));
+    tailAccumulators.resize(tail.numPartitions > 0 ? (size_t) (numOutputs * tail.spectrumSize) : 0);
+    tailOutput.resize(tail.numPartitions > 0 ? (size_t) (numOutputs * tail.blockSize) : 0);
+
+    // Room for the largest transform, which JUCE wants twice the FFT size for
+    fftBuffer.resize((size_t) (4 * (tail.numPartitions > 0 ? tail.blockSize : head.blockSize)));
+
+    reset();
+}
+
+void PartitionedConvolution::reset() noexcept
+{
+    head.reset();
+    tail.reset();
+    std::fill(headAccumulators.begin(), headAccumulators.end(), 0.0f);
+    std::fill(tailAccumulators.begin(), tailAccumulators.end(), 0.0f);
+    std::fill(tailOutput.begin(), tailOutput.end(), 0.0f);
+}
+
+void PartitionedConvolution::process(const float* const* inputs, float* const* outputs, int numSamples) noexcept
+{
+    // The tail's blocks are a whole number of the head's, so a chunk that stays inside
+    // one head block stays inside one tail block too
+    for (int offset = 0; offset < numSamples;)
+    {
+        const int chunk = juce::jmin(numSamples - offset, head.blockSize - head.position);
+        processHead(inputs, outputs, offset, chunk);
+
+        if (tail.numPartitions > 0)
+            processTail(inputs, outputs, offset, chunk);
+
+        offset += chunk;
+    }
+}
+
+void PartitionedConvolution::transformInputs(Level& level) noexcept
+{
+    const int blockSize = level.blockSize;
+    float* buffer = fftBuffer.data();
+
+    for (int input = 0; input < numInputs; ++input)
+    {
+        const float* block = level.inputBlocks.data() + input * blockSize;
+        std::copy(block, block + blockSize, buffer);
+        std::fill(buffer + blockSize, buffer + 2 * blockSize, 0.0f);
+        level.fft->performRealOnlyForwardTransform(buffer, true);
+        std::copy(buffer, buffer + level.spectrumSize, level.getInputSpectrum(input, 0));
+    }
+}
+
+void PartitionedConvolution::processHead(const float* const* inputs, float* const* outputs, int offset, int numSamples) noexcept
+{
+    const int blockSize = head.blockSize;
+    const int numBins = blockSize + 1;
+    const int start = head.position;
+
+    for (int input = 0; input < numInputs; ++input)
+        std::copy(inputs[input] + offset, inputs[input] + offset + numSamples, head.inputBlocks.data() + input * blockSize + start);
+
+    // The older blocks' share of this block's output stays put until the next block
+    if (start == 0)
+    {
+        std::fill(headAccumulators.begin(), headAccumulators.end(), 0.0f);
+
+        for (int output = 0; output < numOutputs; ++output)
+        {
+            float* sum = headAccumulators.data() + output * head.spectrumSize;
+
+            for (int input = 0; input < numInputs; ++input)
+                for (int age = 1; age < head.numPartitions; ++age)
+                    multiplyAccumulate(head.getInputSpectrum(input, age), response->getHeadPartition(getChannel(input, output), age), sum, numBins);
+        }
+    }
+
+    // The block so far, zero-padded, so the output needs no more input than it has
+    transformInputs(head);
+
+    float* buffer = fftBuffer.data();
+
+    for (int output = 0; output < numOutputs; ++output)
+    {
+        const float* sum = headAccumulators.data() + output * head.spectrumSize;
+        std::copy(sum, sum + head.spectrumSize, buffer);
+
+        for (int input = 0; input < numInputs; ++input)
+            multiplyAccumulate(head.getInputSpectrum(input, 0), response->getHeadPartition(getChannel(input, output), 0), buffer, numBins);
+
+        head.fft->performRealOnlyInverseTransform(buffer);
+
+        float* overlap = head.overlap.data() + output * blockSize;
+
+        for (int sample = 0; sample < numSamples; ++sample)
+            outputs[output][offset + sample] = buffer[start + sample] + overlap[start + sample];
+
+        if (start + numSamples == blockSize)
+            std::copy(buffer + blockSize, buffer + 2 * blockSize, overlap);
+    }
+
+    head.position += numSamples;
+
+    if (head.position == blockSize)
+    {
+        std::fill(head.inputBlocks.begin(), head.inputBlocks.end(), 0.0f);
+        head.newest = (head.newest + 1) % head.numPartitions;
+        head.position = 0;
+    }
+}
+
+void PartitionedConvolution::processTail(const float* const* inputs, float* const* outputs, int offset, int numSamples) noexcept
+{
+    const int blockSize = tail.blockSize;
+    const int start = tail.position;
+
+    for (int output = 0; output < numOutputs; ++output)
+        juce::FloatVectorOperations::add(outputs[output] + offset, tailOutput.data() + output * blockSize + start, numSamples);
+
+    for (int input = 0; input < numInputs; ++input)
+        std::copy(inputs[input] + offset, inputs[input] + offset + numSamples, tail.inputBlocks.data() + input * blockSize + start);
+
+    tail.position += numSamples;
+
+    // Only at the end of a head block
+    if (tail.position % head.blockSize != 0)
+        return;
+
+    // The next block's output also takes every older block through partitions 1 and up.
+    // Those are all in already, stored at the age of the partition they meet, so each
+    // head block in this one multiplies in its share of them.
+    const int numSlices = blockSize / head.blockSize;
+    const int slice = tail.position / head.blockSize - 1;
+    const int numOlder = tail.numPartitions - 1;
+    accumulateTail(1 + slice * numOlder / numSlices, 1 + (slice + 1) * numOlder / numSlices);
+
+    if (tail.position < blockSize)
+        return;
+
+    // A whole block is in: its convolution with the tail, which starts a block into the
+    // response, is due from the next block on. It takes the first partition, and the
+    // older blocks' sum is complete.
+    transformInputs(tail);
+
+    float* buffer = fftBuffer.data();
+
+    for (int output = 0; output < numOutputs; ++output)
+    {
+        float* sum = tailAccumulators.data() + output * tail.spectrumSize;
+        std::copy(sum, sum + tail.spectrumSize, buffer);
+        std::fill(sum, sum + tail.spectrumSize, 0.0f);
+
+        for (int input = 0; input < numInputs; ++input)
+            multiplyAccumulate(tail.getInputSpectrum(input, 0), response->getTailPartition(getChannel(input, output), 0), buffer, blockSize + 1);
+
+        tail.fft->performRealOnlyInverseTransform(buffer);
+
+        float* overlap = tail.overlap.data() + output * blockSize;
+        float* destination = tailOutput.data() + output * blockSize;
+
+        for (int sample = 0; sample < blockSize; ++sample)
+            destination[sample] = buffer[sample] + overlap[sample];
+
+        std::copy(buffer + blockSize, buffer + 2 * blockSize, overlap);
+    }
+
+    std::fill(tail.inputBlocks.begin(), tail.inputBlocks.end(), 0.0f);
+    tail.newest = (tail.newest + 1) % tail.numPartitions;
+    tail.position = 0;
+}
+
+void PartitionedConvolution::accumulateTail(int firstAge, int endAge) noexcept
+{
+    const int numBins = tail.blockSize + 1;
+
+    for (int output = 0; output < numOutputs; ++output)
+    {
+        float* sum = tailAccumulators.data() + output * tail.spectrumSize;
+
+        for (int input = 0; input < numInputs; ++input)
+            for (int age = firstAge; age < endAge; ++age)
+                multiplyAccumulate(tail.getInputSpectrum(input, age), response->getTailPartition(getChannel(input, output), age), sum, numBins);
+    }
+}
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <juce_dsp/juce_dsp.h>
+#include <memory>
+#include <vector>
+
+// Zero-latency FFT convolution whose partitioned response is read only, so any number
+// of instances can convolve with one copy of its spectra (see ImpulseResponseCache).
+//
+// Two uniformly partitioned levels, like juce::dsp::Convolution's non-uniform mode. The
+// head covers the first tailBlockSize samples of the response in partitions of
+// headBlockSize, and its newest partition is recomputed on every call, so the output
+// has no latency. The tail covers the rest in partitions of tailBlockSize, and its
+// output for a block is due once the whole input block before it is in; the head's
+// length hides that block of latency. Only the newest tail partition has to wait for
+// that: the older ones are multiplied in a slice per head block while the block fills,
+// so no single callback carries the whole tail.
+// Unlike juce::dsp::Convolution, an instance owns nothing but its input history.
+
+// Partition sizes, in samples; tailBlockSize is a multiple of headBlockSize
+struct ConvolutionLayout
+{
+    int headBlockSize = 0;
+    int tailBlockSize = 0;
+
+    // Head partitions about a host block long, tail partitions eight times that
+    static ConvolutionLayout forBlockSize(int maximumBlockSize) noexcept;
+
+    bool operator==(const ConvolutionLayout& other) const noexcept
+    {
+        return headBlockSize == other.headBlockSize && tailBlockSize == other.tailBlockSize;
+    }
+
+    bool operator!=(const ConvolutionLayout& other) const noexcept { return ! (*this == other); }
+};
+
+// Spectra of every channel of a response. Per channel: the head partitions, then the
+// tail partitions, each the blockSize + 1 bins of its zero-padded real FFT, stored as
+// interleaved real and imaginary floats.
+class PartitionedResponse
+{
+public:
+    // Partitions the response into memory it owns
+    PartitionedResponse(const juce::AudioBuffer<float>& response, const ConvolutionLayout& layoutToUse);
+
+    // Uses spectra already laid out for these sizes, e.g. in a mapped file that `storage`
+    // keeps open
+    PartitionedResponse(const ConvolutionLayout& layoutToUse, int numChannelsIn, int lengthIn,
+                        const float* spectraIn, std::shared_ptr<const void> storageIn);
+
+    const ConvolutionLayout& getLayout() const noexcept { return layout; }
+    int getNumChannels() const noexcept { return numChannels; }
+    int getLength() const noexcept { return length; }
+
+    static int getNumHeadPartitions(const ConvolutionLayout& layout, int length) noexcept;
+    static int getNumTailPartitions(const ConvolutionLayout& layout, int length) noexcept;
+
+    // The whole spectra block, getNumFloats() long
+    const float* getData() const noexcept { return spectra; }
+    size_t getNumFloats() const noexcept { return getNumFloats(layout, numChannels, length); }
+    static size_t getNumFloats(const ConvolutionLayout& layout, int numChannels, int length) noexcept;
+
+    const float* getHeadPartition(int channel, int partition) const noexcept;
+    const float* getTailPartition(int channel, int partition) const noexcept;
+
+private:
+    ConvolutionLayout layout;
+    int numChannels = 0;
+    int length = 0;
+    const float* spectra = nullptr;
+    std::vector<float> ownedSpectra;
+    std::shared_ptr<const void> storage;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PartitionedResponse)
+};
+
+// Convolves numInputs signals into numOutputs, input i reaching output o through the
+// response's channel firstChannel + i * numOutputs + o. For a true stereo pair that's
+// left-to-left, left-to-right, right-to-left, right-to-right.
+class PartitionedConvolution
+{
+public:
+    // Allocates the input history, so create it off the audio thread
+    PartitionedConvolution(std::shared_ptr<const PartitionedResponse> responseToUse,
+                           int numInputsToUse, int numOutputsToUse, int firstChannelToUse);
+
+    void reset() noexcept;
+
+    // Any number of samples. The outputs are overwritten, and mustn't alias the inputs.
+    void process(const float* const* inputs, float* const* outputs, int numSamples) noexcept;
+
+    const PartitionedResponse& getResponse() const noexcept { return *response; }
+
+private:
+    // One partitioning level: the input block being filled, the spectra of the last
+    // numPartitions input blocks, and the second half of each output's last inverse FFT
+    struct Level
+    {
+        int blockSize = 0;
+        int numPartitions = 0;
+        int spectrumSize = 0; // floats per partition spectrum
+        std::unique_ptr<juce::dsp::FFT> fft;
+        std::vector<float> inputBlocks;
+        std::vector<float> inputSpectra;
+        std::vector<float> overlap;
+        int newest = 0;
+        int position = 0;
+
+        void prepare(int blockSizeToUse, int numPartitionsToUse, int numInputs, int numOutputs);
+        void reset() noexcept;
+        float* getInputSpectrum(int input, int age) noexcept;
+    };
+
+    std::shared_ptr<const PartitionedResponse> response;
+    int numInputs = 0;
+    int numOutputs = 0;
+    int firstChannel = 0;
+
+    Level head, tail;
+
+    // Head: every output's sum over the older input blocks, fixed for the current block.
+    // Tail: every output's sum over the older input blocks for the next block, built up
+    // while the current one fills, and its samples for the current block, computed at
+    // the end of the last.
+    std::vector<float> headAccumulators;
+    std::vector<float> tailAccumulators;
+    std::vector<float> tailOutput;
+    std::vector<float> fftBuffer;
+
+    void processHead(const float* const* inputs, float* const* outputs, int offset, int numSamples) noexcept;
+    void processTail(const float* const* inputs, float* const* outputs, int offset, int numSamples) noexcept;
+    void accumulateTail(int firstAge, int endAge) noexcept;
+    void transformInputs(Level& level) noexcept;
+    int getChannel(int input, int output) const noexcept { return firstChannel + input * numOutputs + output; }
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PartitionedConvolution)
+};
@@ -3,6 +3,108 @@
 #include <JuceHeader.h>
 #include "PluginProcessor.h"
 
+#if WAVEFOLD_REVERB_STAGE_PROFILING
+// Live CPU load of each engine stage, as a share of real time, drained from the
+// processor's stage profiler. Keeps the most recent blocks for the CSV dump.
+class StageBreakdown : public juce::Component,
+                       private juce::Timer
+{
+public:
+    explicit StageBreakdown(StageProfiler& profilerToShow)
+        : profiler(profilerToShow)
+    {
+        // Calibrate the counter now rather than in the first timer callback
+        ticksPerSecond = StageProfiler::getTicksPerSecond();
+        history.reserve(maxHistory);
+        startTimerHz(10);
+    }
+
+    ~StageBreakdown() override { stopTimer(); }
+
+    void paint(juce::Graphics& g) override
+    {
+        const int rowHeight = getHeight() / StageProfiler::numStages;
+        const int nameWidth = 80;
+        const int valueWidth = 70;
+        const int barWidth = getWidth() - nameWidth - valueWidth;
+
+        // Bars are relative to the busiest stage; the text is the share of real time
+        const double busiest = juce::jmax(1.0e-9, *std::max_element(loads.begin(), loads.end()));
+
+        g.setFont(14.0f);
+
+        for (int stage = 0; stage < StageProfiler::numStages; ++stage)
+        {
+            const int y = stage * rowHeight;
+            const double load = loads[(size_t) stage];
+
+            g.setColour(juce::Colours::white);
+            g.drawText(StageProfiler::getStageName(stage), 0, y, nameWidth, rowHeight, juce::Justification::left);
+            g.drawText(juce::String(load * 100.0, 2) + " %", nameWidth + barWidth, y, valueWidth, rowHeight,
+                       juce::Justification::right);
+
+            g.setColour(juce::Colours::orange);
+            g.fillRect(nameWidth, y + 4, juce::roundToInt(barWidth * load / busiest), rowHeight - 8);
+        }
+    }
+
+    // Writes the kept blocks, oldest first
+    bool writeCsv(const juce::File& file) const
+    {
+        return file.replaceWithText(StageProfiler::toCsv(history.data(), (int) history.size()));
+    }
+
+private:
+    void timerCallback() override
+    {
+        std::array<juce::uint64, StageProfiler::numStages> ticks {};
+        double seconds = 0.0;
+        int numPopped;
+
+        while ((numPopped = profiler.pop(scratch.data(), (int) scratch.size())) > 0)
+        {
+            for (int i = 0; i < numPopped; ++i)
+            {
+                const auto& timing = scratch[(size_t) i];
+
+                for (size_t stage = 0; stage < ticks.size(); ++stage)
+                    ticks[stage] += timing.ticks[stage];
+
+                if (timing.sampleRate > 0.0)
+                    seconds += timing.numSamples / timing.sampleRate;
+
+                // Drop the older half once full, so dumps cover roughly the last minute
+                if (history.size() == maxHistory)
+                    history.erase(history.begin(), history.begin() + (std::ptrdiff_t) maxHistory / 2);
+
+                history.push_back(timing);
+            }
+        }
+
+        if (seconds <= 0.0)
+            return;
+
+        for (size_t stage = 0; stage < loads.size(); ++stage)
+        {
+            const double load = (double) ticks[stage] / (ticksPerSecond * seconds);
+            loads[stage] += 0.3 * (load - loads[stage]);
+        }
+
+        repaint();
+    }
+
+    static constexpr size_t maxHistory = 32768;
+
+    StageProfiler& profiler;
+    double ticksPerSecond = 1.0;
+    std::array<double, StageProfiler::numStages> loads {};
+    std::array<StageProfiler::BlockTiming, 256> scratch;
+    std::vector<StageProfiler::BlockTiming> history;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(StageBreakdown)
+};
+#endif
+
 class ReverbWavefolderEditor : public juce::AudioProcessorEditor
 {
 public:
@@ -42,6 +144,54 @@ public:
         wavefoldPosCombo.setSelectedId(3); // Default to Post-Reverb
         addAndMakeVisible(wavefoldPosCombo);
         
+        // Oversampling combo box
+        oversamplingLabel.setText("Oversampling", juce::dontSendNotification);
+        addAndMakeVisible(oversamplingLabel);
+        
+        oversamplingCombo.addItem("Off", 1);
+        oversamplingCombo.addItem("2x", 2);
+        oversamplingCombo.addItem("4x", 3);
+        oversamplingCombo.addItem("8x", 4);
+        oversamplingCombo.setSelectedId(1);
+        addAndMakeVisible(oversamplingCombo);
+        
+        // Anti-aliasing combo box
+        antialiasingLabel.setText("Anti-Aliasing", juce::dontSendNotification);
+        addAndMakeVisible(antialiasingLabel);
+        
+        antialiasingCombo.addItem("Off", 1);
+        antialiasingCombo.addItem("ADAA 1st Order", 2);
+        antialiasingCombo.addItem("ADAA 2nd Order", 3);
+        antialiasingCombo.setSelectedId(1);
+        addAndMakeVisible(antialiasingCombo);
+        
+        // In-loop delay line count combo box
+        fdnLinesLabel.setText("In-Loop Lines", juce::dontSendNotification);
+        addAndMakeVisible(fdnLinesLabel);
+        
+        fdnLinesCombo.addItem("8", 1);
+        fdnLinesCombo.addItem("16", 2);
+        fdnLinesCombo.setSelectedId(1);
+        addAndMakeVisible(fdnLinesCombo);
+        
+        // Fold mode combo box
+        foldModeLabel.setText("Fold Mode", juce::dontSendNotification);
+        addAndMakeVisible(foldModeLabel);
+        
+        foldModeCombo.addItem("Direct", 1);
+        foldModeCombo.addItem("Lookup Table", 2);
+        foldModeCombo.setSelectedId(1);
+        addAndMakeVisible(foldModeCombo);
+        
+        // Reverb mode combo box
+        reverbModeLabel.setText("Reverb Mode", juce::dontSendNotification);
+        addAndMakeVisible(reverbModeLabel);
+        
+        reverbModeCombo.addItem("Live", 1);
+        reverbModeCombo.addItem("Frozen", 2);
+        reverbModeCombo.setSelectedId(1);
+        addAndMakeVisible(reverbModeCombo);
+        
         // Set up parameter attachments
         sizeAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
             processor.parameters, "size", sizeSlider);
@@ -77,9 +227,34 @@ public:
             processor.parameters, "preDelay", preDelaySlider);
         wavefoldPosAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(
             processor.parameters, "wavefoldPosition", wavefoldPosCombo);
+        oversamplingAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(
+            processor.parameters, "oversampling", oversamplingCombo);
+        antialiasingAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(
+            processor.parameters, "antialiasing", antialiasingCombo);
+        fdnLinesAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(
+            processor.parameters, "fdnLines", fdnLinesCombo);
+        foldModeAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(
+            processor.parameters, "foldMode", foldModeCombo);
+        reverbModeAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(
+            processor.parameters, "reverbMode", reverbModeCombo);
+
+       #if WAVEFOLD_REVERB_STAGE_PROFILING
+        // Per-stage CPU breakdown, development builds only
+        addAndMakeVisible(stageBreakdown);
+        addAndMakeVisible(dumpCsvButton);
+        addAndMakeVisible(dumpCsvLabel);
+
+        dumpCsvButton.onClick = [this]
+        {
+            const auto file = juce::File::getSpecialLocation(juce::File::userDesktopDirectory)
+                                  .getNonexistentChildFile("WavefoldReverb stages", ".csv");
+            dumpCsvLabel.setText(stageBreakdown.writeCsv(file) ? file.getFileName() : "Couldn't write " + file.getFileName(),
+                                 juce::dontSendNotification);
+        };
+       #endif
             
         // Set window size
-        setSize(800, 600);
+        setSize(800, 720);
     }
 
     ~ReverbWavefolderEditor() override = default;
@@ -95,6 +270,10 @@ public:
         g.drawText("Reverb", 20, 10, 350, 30, juce::Justification::left);
         g.drawText("Wavefolder", 420, 10, 350, 30, juce::Justification::left);
         g.drawText("Mix", 20, 320, 350, 30, juce::Justification::left);
+
+       #if WAVEFOLD_REVERB_STAGE_PROFILING
+        g.drawText("CPU by Stage", 420, 320, 350, 30, juce::Justification::left);
+       #endif
         
         // Draw section dividers
         g.setColour(juce::Colours::lightgrey);
@@ -176,6 +355,33 @@ public:
         y += controlHeight + margin;
         wavefoldPosLabel.setBounds(20, y, labelWidth, controlHeight);
         wavefoldPosCombo.setBounds(20 + labelWidth, y, sliderWidth, controlHeight);
+        
+        y += controlHeight + margin;
+        oversamplingLabel.setBounds(20, y, labelWidth, controlHeight);
+        oversamplingCombo.setBounds(20 + labelWidth, y, sliderWidth, controlHeight);
+        
+        y += controlHeight + margin;
+        antialiasingLabel.setBounds(20, y, labelWidth, controlHeight);
+        antialiasingCombo.setBounds(20 + labelWidth, y, sliderWidth, controlHeight);
+        
+        y += controlHeight + margin;
+        fdnLinesLabel.setBounds(20, y, labelWidth, controlHeight);
+        fdnLinesCombo.setBounds(20 + labelWidth, y, sliderWidth, controlHeight);
+        
+        y += controlHeight + margin;
+        foldModeLabel.setBounds(20, y, labelWidth, controlHeight);
+        foldModeCombo.setBounds(20 + labelWidth, y, sliderWidth, controlHeight);
+        
+        y += controlHeight + margin;
+        reverbModeLabel.setBounds(20, y, labelWidth, controlHeight);
+        reverbModeCombo.setBounds(20 + labelWidth, y, sliderWidth, controlHeight);
+
+       #if WAVEFOLD_REVERB_STAGE_PROFILING
+        // Stage breakdown beside the mix section
+        stageBreakdown.setBounds(420, 370, 360, 8 * controlHeight);
+        dumpCsvButton.setBounds(420, 370 + 8 * controlHeight + margin, 100, controlHeight);
+        dumpCsvLabel.setBounds(530, 370 + 8 * controlHeight + margin, 250, controlHeight);
+       #endif
     }
 
 private:
@@ -210,6 +416,23 @@ private:
     juce::Label dryWetLabel, preDelayLabel;
     juce::ComboBox wavefoldPosCombo;
     juce::Label wavefoldPosLabel;
+    juce::ComboBox oversamplingCombo;
+    juce::Label oversamplingLabel;
+    juce::ComboBox antialiasingCombo;
+    juce::Label antialiasingLabel;
+    juce::ComboBox fdnLinesCombo;
+    juce::Label fdnLinesLabel;
+    juce::ComboBox foldModeCombo;
+    juce::Label foldModeLabel;
+    juce::ComboBox reverbModeCombo;
+    juce::Label reverbModeLabel;
+
+   #if WAVEFOLD_REVERB_STAGE_PROFILING
+    // Stage timing display
+    StageBreakdown stageBreakdown { processor.getStageProfiler() };
+    juce::TextButton dumpCsvButton { "Dump CSV" };
+    juce::Label dumpCsvLabel;
+   #endif
     
     // Parameter attachments
     std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> sizeAttachment;
@@ -230,6 +453,11 @@ private:
     std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> dryWetAttachment;
     std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> preDelayAttachment;
     std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> wavefoldPosAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> oversamplingAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> antialiasingAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> fdnLinesAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> foldModeAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> reverbModeAttachment;
     
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ReverbWavefolderEditor)
 };
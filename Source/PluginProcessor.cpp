@@ -1,6 +1,40 @@
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
 
+namespace
+{
+    // APVTS ID of every engine parameter and its bit in the change mask
+    struct ParameterFlag
+    {
+        const char* id;
+        WavefoldReverbEngine::ParameterMask flag;
+    };
+
+    const ParameterFlag parameterFlags[] = {
+        { "size", WavefoldReverbEngine::sizeFlag },
+        { "decay", WavefoldReverbEngine::decayFlag },
+        { "diffusion", WavefoldReverbEngine::diffusionFlag },
+        { "density", WavefoldReverbEngine::densityFlag },
+        { "lowEQ", WavefoldReverbEngine::lowEQFlag },
+        { "midEQ", WavefoldReverbEngine::midEQFlag },
+        { "highEQ", WavefoldReverbEngine::highEQFlag },
+        { "drive", WavefoldReverbEngine::driveFlag },
+        { "threshold", WavefoldReverbEngine::thresholdFlag },
+        { "offset", WavefoldReverbEngine::offsetFlag },
+        { "fundamental", WavefoldReverbEngine::fundamentalFlag },
+        { "foldSymmetry", WavefoldReverbEngine::foldSymmetryFlag },
+        { "waveformShape", WavefoldReverbEngine::waveformShapeFlag },
+        { "dryWet", WavefoldReverbEngine::dryWetFlag },
+        { "preDelay", WavefoldReverbEngine::preDelayFlag },
+        { "wavefoldPosition", WavefoldReverbEngine::wavefoldPositionFlag },
+        { "oversampling", WavefoldReverbEngine::oversamplingFlag },
+        { "antialiasing", WavefoldReverbEngine::antialiasingFlag },
+        { "fdnLines", WavefoldReverbEngine::fdnLinesFlag },
+        { "foldMode", WavefoldReverbEngine::foldModeFlag },
+        { "reverbMode", WavefoldReverbEngine::reverbModeFlag }
+    };
+}
+
 ReverbWavefolderAudioProcessor::ReverbWavefolderAudioProcessor()
     : AudioProcessor(BusesProperties()
         .withInput("Input", juce::AudioChannelSet::stereo(), true)
@@ -29,9 +63,29 @@ ReverbWavefolderAudioProcessor::ReverbWavefolderAudioProcessor()
     dryWetParam = parameters.getRawParameterValue("dryWet");
     preDelayParam = parameters.getRawParameterValue("preDelay");
     wavefoldPositionParam = parameters.getRawParameterValue("wavefoldPosition");
+    oversamplingParam = parameters.getRawParameterValue("oversampling");
+    antialiasingParam = parameters.getRawParameterValue("antialiasing");
+    fdnLinesParam = parameters.getRawParameterValue("fdnLines");
+    foldModeParam = parameters.getRawParameterValue("foldMode");
+    reverbModeParam = parameters.getRawParameterValue("reverbMode");
+
+    for (const auto& parameter : parameterFlags)
+        parameters.addParameterListener(parameter.id, this);
+
+   #if WAVEFOLD_REVERB_STAGE_PROFILING
+    // Only one engine runs at a time, so they can share the one producer slot
+    engine.setStageProfiler(&stageProfiler);
+    doubleEngine.setStageProfiler(&stageProfiler);
+   #endif
 }
 
-ReverbWavefolderAudioProcessor::~ReverbWavefolderAudioProcessor() {}
+ReverbWavefolderAudioProcessor::~ReverbWavefolderAudioProcessor()
+{
+    for (const auto& parameter : parameterFlags)
+        parameters.removeParameterListener(parameter.id, this);
+
+    cancelPendingUpdate();
+}
 
 juce::AudioProcessorValueTreeState::ParameterLayout ReverbWavefolderAudioProcessor::createParameterLayout()
 {
@@ -59,214 +113,178 @@ juce::AudioProcessorValueTreeState::ParameterLayout ReverbWavefolderAudioProcess
     layout.add(std::make_unique<juce::AudioParameterFloat>("preDelay", "Pre-Delay", 0.0f, 500.0f, 0.0f));
     layout.add(std::make_unique<juce::AudioParameterChoice>("wavefoldPosition", "Wavefold Position",
         juce::StringArray("Pre-Reverb", "In-Reverb Loop", "Post-Reverb"), 2));
+    layout.add(std::make_unique<juce::AudioParameterChoice>("oversampling", "Oversampling",
+        juce::StringArray("Off", "2x", "4x", "8x"), 0));
+    layout.add(std::make_unique<juce::AudioParameterChoice>("antialiasing", "Anti-Aliasing",
+        juce::StringArray("Off", "ADAA 1st Order", "ADAA 2nd Order"), 0));
+    layout.add(std::make_unique<juce::AudioParameterChoice>("fdnLines", "In-Loop Delay Lines",
+        juce::StringArray("8", "16"), 0));
+    layout.add(std::make_unique<juce::AudioParameterChoice>("foldMode", "Fold Mode",
+        juce::StringArray("Direct", "Lookup Table"), 0));
+    layout.add(std::make_unique<juce::AudioParameterChoice>("reverbMode", "Reverb Mode",
+        juce::StringArray("Live", "Frozen"), 0));
     
     return layout;
 }
 
 void ReverbWavefolderAudioProcessor::prepareToPlay(double sampleRate, int samplesPerBlock)
 {
-    currentSampleRate = sampleRate;
-
-    // Set up pre-delay
-    preDelay.reset();
-    preDelay.prepare({ sampleRate, (juce::uint32) samplesPerBlock, 2 });
-    preDelay.setMaximumDelayInSamples(sampleRate * 0.5); // Max 500ms pre-delay
-    
-    // Set up reverb
-    updateReverbParameters();
-   
     juce::dsp::ProcessSpec spec;
-        spec.sampleRate = sampleRate;
-        spec.maximumBlockSize = samplesPerBlock;
-        spec.numChannels = getTotalNumInputChannels();
-        
-        reverb.prepare(spec);
-        reverb.reset();
-    
-    // Set up wavefolder
-    wavefolder.prepare(spec);
-    
-    // Prepare buffers
-    dryBuffer.setSize(getTotalNumInputChannels(), samplesPerBlock);
-    wetBuffer.setSize(getTotalNumInputChannels(), samplesPerBlock);
-    preFoldBuffer.setSize(getTotalNumInputChannels(), samplesPerBlock);
-    postFoldBuffer.setSize(getTotalNumInputChannels(), samplesPerBlock);
+    spec.sampleRate = sampleRate;
+    spec.maximumBlockSize = (juce::uint32) samplesPerBlock;
+    spec.numChannels = (juce::uint32) getTotalNumInputChannels();
+
+    // Start from a full snapshot; changes from here on set their bits again
+    changedParameters.store(0);
+    loadParameters(snapshot, WavefoldReverbEngine::allParameters);
+
+    // The host sets the processing precision before preparing
+    if (isUsingDoublePrecision())
+    {
+        doubleEngine.setParameters(snapshot, WavefoldReverbEngine::allParameters);
+        doubleEngine.prepare(spec);
+    }
+    else
+    {
+        engine.setParameters(snapshot, WavefoldReverbEngine::allParameters);
+        engine.prepare(spec);
+    }
+
+    // The fold oversampling delays the whole output, wet and (compensated) dry. This
+    // covers any switch still waiting for handleAsyncUpdate().
+    cancelPendingUpdate();
+    setLatencySamples(getEngineLatencyInSamples(snapshot));
 }
 
 void ReverbWavefolderAudioProcessor::releaseResources() {}
 
-void ReverbWavefolderAudioProcessor::updateReverbParameters()
+void ReverbWavefolderAudioProcessor::loadParameters(WavefoldReverbEngine::Parameters& p, ParameterMask mask) const
 {
-    reverbParams.roomSize = *sizeParam;
-    reverbParams.damping = 1.0f - *decayParam / 20.0f; // Convert decay time to damping
-    
-    // Ensure damping isn't too low at high decay values
-    // Apply a minimum damping value
-    if (reverbParams.damping < 0.05f)
-            reverbParams.damping = 0.05f;
-    
-    reverbParams.width = *diffusionParam;
-    reverbParams.wetLevel = 1.0f; // Handle dry/wet separately
-    reverbParams.dryLevel = 0.0f; // Handle dry/wet separately
-    reverb.setParameters(reverbParams);
+    // Only the flagged fields are read from their atomics
+    auto load = [mask] (auto& field, ParameterMask flag, const std::atomic<float>* source)
+    {
+        if ((mask & flag) != 0)
+            field = static_cast<std::remove_reference_t<decltype(field)>>(source->load(std::memory_order_relaxed));
+    };
+
+    // Reverb parameters
+    load(p.size, WavefoldReverbEngine::sizeFlag, sizeParam);
+    load(p.decay, WavefoldReverbEngine::decayFlag, decayParam);
+    load(p.diffusion, WavefoldReverbEngine::diffusionFlag, diffusionParam);
+    load(p.density, WavefoldReverbEngine::densityFlag, densityParam);
+    load(p.lowEQ, WavefoldReverbEngine::lowEQFlag, lowEQParam);
+    load(p.midEQ, WavefoldReverbEngine::midEQFlag, midEQParam);
+    load(p.highEQ, WavefoldReverbEngine::highEQFlag, highEQParam);
+
+    // Wavefolder parameters
+    load(p.drive, WavefoldReverbEngine::driveFlag, driveParam);
+    load(p.threshold, WavefoldReverbEngine::thresholdFlag, thresholdParam);
+    load(p.offset, WavefoldReverbEngine::offsetFlag, offsetParam);
+    load(p.fundamental, WavefoldReverbEngine::fundamentalFlag, fundamentalParam);
+    load(p.foldSymmetry, WavefoldReverbEngine::foldSymmetryFlag, foldSymmetryParam);
+    load(p.waveformShape, WavefoldReverbEngine::waveformShapeFlag, waveformShapeParam);
+
+    // Additional parameters
+    load(p.dryWet, WavefoldReverbEngine::dryWetFlag, dryWetParam);
+    load(p.preDelay, WavefoldReverbEngine::preDelayFlag, preDelayParam);
+    load(p.wavefoldPosition, WavefoldReverbEngine::wavefoldPositionFlag, wavefoldPositionParam);
+    load(p.oversampling, WavefoldReverbEngine::oversamplingFlag, oversamplingParam);
+    load(p.antialiasing, WavefoldReverbEngine::antialiasingFlag, antialiasingParam);
+    load(p.fdnLines, WavefoldReverbEngine::fdnLinesFlag, fdnLinesParam);
+    load(p.foldMode, WavefoldReverbEngine::foldModeFlag, foldModeParam);
+    load(p.reverbMode, WavefoldReverbEngine::reverbModeFlag, reverbModeParam);
 }
 
+WavefoldReverbEngine::Parameters ReverbWavefolderAudioProcessor::getEngineParameters() const
+{
+    WavefoldReverbEngine::Parameters p;
+    loadParameters(p, WavefoldReverbEngine::allParameters);
+    return p;
+}
+
+double ReverbWavefolderAudioProcessor::getTailLengthSeconds() const
+{
+    if (isUsingDoublePrecision())
+        return doubleEngine.getTailLengthSeconds(getEngineParameters());
 
+    return engine.getTailLengthSeconds(getEngineParameters());
+}
 
-void ReverbWavefolderAudioProcessor::applyWavefolding(juce::AudioBuffer<float>& buffer, int startSample, int numSamples)
+int ReverbWavefolderAudioProcessor::getEngineLatencyInSamples(const WavefoldReverbEngine::Parameters& parameters) const
 {
-    const float drive = *driveParam;
-    const float threshold = *thresholdParam;
-    const float offset = *offsetParam;
-    const float fold = *foldSymmetryParam;
-    const float shape = *waveformShapeParam;
-    const float fundamental = *fundamentalParam;
-    
-    // Use custom wavefolder class
-    wavefolder.processBlock(buffer, drive, threshold, offset, fold, shape, fundamental);
-    
-    // Add DC blocking (important for pre-reverb position)
-    static float prevIn[2] = {0.0f, 0.0f};
-    static float prevOut[2] = {0.0f, 0.0f};
-    
-    const float dcBlockCoeff = 0.995f;
-    
-    for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
-    {
-        float* channelData = buffer.getWritePointer(channel);
-        
-        for (int sample = 0; sample < numSamples; ++sample)
-        {
-            const float input = channelData[sample];
-            channelData[sample] = input - prevIn[channel] + dcBlockCoeff * prevOut[channel];
-            prevIn[channel] = input;
-            prevOut[channel] = channelData[sample];
-        }
-    }
+    if (isUsingDoublePrecision())
+        return doubleEngine.getLatencyInSamples(parameters);
+
+    return engine.getLatencyInSamples(parameters);
 }
-void ReverbWavefolderAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
+
+void ReverbWavefolderAudioProcessor::parameterChanged(const juce::String& parameterID, float newValue)
 {
-    juce::ScopedNoDenormals noDenormals;
-    const int numSamples = buffer.getNumSamples();
-    const int numChannels = buffer.getNumChannels();
-    
-    // Update the reverb parameters
-    updateReverbParameters();
-    
-    // Save dry buffer for later mixing
-    dryBuffer.copyFrom(0, 0, buffer, 0, 0, numSamples);
-    if (numChannels > 1)
-        dryBuffer.copyFrom(1, 0, buffer, 1, 0, numSamples);
-        
-    // Apply pre-delay
-    const float preDelayMs = *preDelayParam;
-    const float preDelayInSamples = preDelayMs * 0.001f * getSampleRate();
-    
-    for (int channel = 0; channel < numChannels; ++channel)
+    for (const auto& parameter : parameterFlags)
     {
-        float* channelData = buffer.getWritePointer(channel);
-        
-        for (int sample = 0; sample < numSamples; ++sample)
+        if (parameterID == parameter.id)
         {
-            preDelay.pushSample(channel, channelData[sample]);
-            channelData[sample] = preDelay.popSample(channel, preDelayInSamples);
+            changedParameters.fetch_or(parameter.flag);
+            break;
         }
     }
-    
-    // Copy the buffer for potential pre-reverb wavefolding
-    wetBuffer.copyFrom(0, 0, buffer, 0, 0, numSamples);
-    if (numChannels > 1)
-        wetBuffer.copyFrom(1, 0, buffer, 1, 0, numSamples);
-    
-    // Get the wavefold position
-    const int wavefoldPos = static_cast<int>(*wavefoldPositionParam);
-    
-    // Apply wavefolding based on position
-    if (wavefoldPos == WavefoldPosition::PRE_REVERB)
-    {
-        applyWavefolding(wetBuffer, 0, numSamples);
-    }
-    
-    // Apply reverb
-    juce::dsp::AudioBlock<float> block(wetBuffer);
-    juce::dsp::ProcessContextReplacing<float> context(block);
-    reverb.process(context);
-    
-    // Apply wavefolding in reverb loop or post-reverb
-    if (wavefoldPos == WavefoldPosition::IN_REVERB_LOOP)
-    {
-        // In-loop folding (simplified implementation - in a real implementation
-        // you'd need to integrate the folding into the reverb's feedback loop)
-        applyWavefolding(wetBuffer, 0, numSamples);
-    }
-    else if (wavefoldPos == WavefoldPosition::POST_REVERB)
+
+    // The fold position decides whether the oversampling runs at all, and the lookup
+    // fold mode needs its table allocated
+    if (parameterID == "oversampling" || parameterID == "wavefoldPosition" || parameterID == "foldMode")
+        triggerAsyncUpdate();
+}
+
+void ReverbWavefolderAudioProcessor::handleAsyncUpdate()
+{
+    const auto engineParameters = getEngineParameters();
+    setLatencySamples(getEngineLatencyInSamples(engineParameters));
+
+    if (engineParameters.foldMode == 1)
     {
-        applyWavefolding(wetBuffer, 0, numSamples);
+        if (isUsingDoublePrecision())
+            doubleEngine.prepareLookupTable();
+        else
+            engine.prepareLookupTable();
     }
-    
-    // Mix dry and wet signals
-    const float wet = *dryWetParam;
-    const float dry = 1.0f - wet;
-    
-    for (int channel = 0; channel < numChannels; ++channel)
-    {
-        float* channelData = buffer.getWritePointer(channel);
-        const float* dryData = dryBuffer.getReadPointer(channel);
-        const float* wetData = wetBuffer.getReadPointer(channel);
-        
-        for (int sample = 0; sample < numSamples; ++sample)
-        {
-            channelData[sample] = dryData[sample] * dry + wetData[sample] * wet;
-        }
-    }
-    
-    // Apply noise gate to eliminate ghost signals
-    bool hasSignal = false;
-    for (int channel = 0; channel < numChannels && !hasSignal; ++channel)
-        {
-            float* channelData = buffer.getWritePointer(channel);
-            
-            for (int sample = 0; sample < numSamples; ++sample)
-            {
-                if (std::abs(channelData[sample]) > noiseGateThreshold)
-                {
-                    hasSignal = true;
-                    silenceCounter = 0;
-                    break;
-                }
-            }
-        }
-        
-        if (!hasSignal)
-        {
-            silenceCounter += numSamples;
-            
-            if (silenceCounter > silenceCounterThreshold)
-            {
-                // Completely silence the output after the threshold is reached
-                for (int channel = 0; channel < numChannels; ++channel)
-                {
-                    buffer.clear(channel, 0, numSamples);
-                }
-                
-                // Also clear the internal state of the reverb to prevent ghost outputs
-                if (silenceCounter == silenceCounterThreshold + numSamples)
-                {
-                    reverb.reset();
-                    wavefolder.reset();
-                }
-            }
-        }
+}
+
+template <typename SampleType>
+void ReverbWavefolderAudioProcessor::processWithEngine(BasicWavefoldReverbEngine<SampleType>& chain,
+                                                       juce::AudioBuffer<SampleType>& buffer)
+{
+    juce::ScopedNoDenormals noDenormals;
+
+    // One snapshot per block, touching only the parameters that moved since the last
+    const auto changed = changedParameters.exchange(0);
+
+    if (changed != 0)
+        loadParameters(snapshot, changed);
+
+    chain.setParameters(snapshot, changed);
+    chain.process(buffer);
+}
+
+void ReverbWavefolderAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
+{
+    processWithEngine(engine, buffer);
+}
+
+void ReverbWavefolderAudioProcessor::processBlock(juce::AudioBuffer<double>& buffer, juce::MidiBuffer& midiMessages)
+{
+    processWithEngine(doubleEngine, buffer);
 }
 
 bool ReverbWavefolderAudioProcessor::isBusesLayoutSupported(const BusesLayout& layouts) const
 {
-    // Support mono and stereo layouts
-    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono() &&
-        layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
+    // Any layout (mono, stereo, 5.1, 7.1, 7.1.4, ...) as long as input matches output;
+    // the engine processes every channel
+    const auto& output = layouts.getMainOutputChannelSet();
+    
+    if (output.isDisabled() || output.size() > maxChannels)
         return false;
     
-    if (layouts.getMainOutputChannelSet() != layouts.getMainInputChannelSet())
+    if (output != layouts.getMainInputChannelSet())
         return false;
     
     return true;
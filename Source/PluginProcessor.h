@@ -1,9 +1,11 @@
 #pragma once
 
 #include <JuceHeader.h>
-#include "Wavefolder.h" // Include our custom wavefolder
+#include "WavefoldReverbEngine.h"
 
-class ReverbWavefolderAudioProcessor : public juce::AudioProcessor
+class ReverbWavefolderAudioProcessor : public juce::AudioProcessor,
+                                       private juce::AudioProcessorValueTreeState::Listener,
+                                       private juce::AsyncUpdater
 {
 public:
     ReverbWavefolderAudioProcessor();
@@ -12,6 +14,11 @@ public:
     void prepareToPlay(double sampleRate, int samplesPerBlock) override;
     void releaseResources() override;
     void processBlock(juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    void processBlock(juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
+
+    // The whole chain runs natively in double, so hosts mixing in double skip the
+    // conversion to float and back
+    bool supportsDoublePrecisionProcessing() const override { return true; }
 
     bool isBusesLayoutSupported(const BusesLayout& layouts) const override;
     
@@ -23,7 +30,7 @@ public:
     bool acceptsMidi() const override { return false; }
     bool producesMidi() const override { return false; }
     bool isMidiEffect() const override { return false; }
-    double getTailLengthSeconds() const override { return 0.0; }
+    double getTailLengthSeconds() const override;
 
     int getNumPrograms() override { return 1; }
     int getCurrentProgram() override { return 0; }
@@ -34,21 +41,20 @@ public:
     void getStateInformation(juce::MemoryBlock& destData) override;
     void setStateInformation(const void* data, int sizeInBytes) override;
 
-    enum WavefoldPosition {
-        PRE_REVERB,
-        IN_REVERB_LOOP,
-        POST_REVERB
-    };
+    using WavefoldPosition = WavefoldReverbEngine::WavefoldPosition;
+
+    // Widest bus accepted, enough for 9.1.6
+    static constexpr int maxChannels = 16;
 
     // Audio Parameters
     juce::AudioProcessorValueTreeState parameters;
 
-private:
-    // noise gate to cut signals below threshold - avoids signal bleed
-    float noiseGateThreshold = 0.0001f; // Adjust this value as needed
-    int silenceCounter = 0;
-    int silenceCounterThreshold = 1000; // Approx. 20ms at 48kHz
+   #if WAVEFOLD_REVERB_STAGE_PROFILING
+    // Per-stage timings of every block, for the editor's CPU breakdown
+    StageProfiler& getStageProfiler() noexcept { return stageProfiler; }
+   #endif
 
+private:
     // Reverb parameters
     std::atomic<float>* sizeParam = nullptr;
     std::atomic<float>* decayParam = nullptr;
@@ -70,23 +76,43 @@ private:
     std::atomic<float>* dryWetParam = nullptr;
     std::atomic<float>* preDelayParam = nullptr;
     std::atomic<float>* wavefoldPositionParam = nullptr;
+    std::atomic<float>* oversamplingParam = nullptr;
+    std::atomic<float>* antialiasingParam = nullptr;
+    std::atomic<float>* fdnLinesParam = nullptr;
+    std::atomic<float>* foldModeParam = nullptr;
+    std::atomic<float>* reverbModeParam = nullptr;
 
-    // DSP Components
-    juce::dsp::DelayLine<float, juce::dsp::DelayLineInterpolationTypes::Linear> preDelay;
-    juce::dsp::Reverb::Parameters reverbParams;
-    juce::dsp::Reverb reverb;
-    Wavefolder wavefolder;
-    
-    // Internal buffers
-    juce::AudioBuffer<float> dryBuffer;
-    juce::AudioBuffer<float> wetBuffer;
-    juce::AudioBuffer<float> preFoldBuffer;
-    juce::AudioBuffer<float> postFoldBuffer;
-    double currentSampleRate = 44100.0;
-    
-    // Internal methods
-    void applyWavefolding(juce::AudioBuffer<float>& buffer, int startSample, int numSamples);
-    void updateReverbParameters();
+    // GUI-free signal chain, one per precision; only the one matching the host's
+    // processing precision is prepared
+    WavefoldReverbEngine engine;
+    WavefoldReverbEngineDouble doubleEngine;
+
+   #if WAVEFOLD_REVERB_STAGE_PROFILING
+    StageProfiler stageProfiler;
+   #endif
+
+    using ParameterMask = WavefoldReverbEngine::ParameterMask;
+
+    // Audio thread copy of the parameters, on its own cache lines. Listeners flag what
+    // moved in changedParameters, and each block only those values are reloaded.
+    alignas (64) WavefoldReverbEngine::Parameters snapshot;
+    std::atomic<ParameterMask> changedParameters { WavefoldReverbEngine::allParameters };
+
+    void loadParameters(WavefoldReverbEngine::Parameters& destination, ParameterMask mask) const;
+    WavefoldReverbEngine::Parameters getEngineParameters() const;
+    int getEngineLatencyInSamples(const WavefoldReverbEngine::Parameters& parameters) const;
+
+    template <typename SampleType>
+    void processWithEngine(BasicWavefoldReverbEngine<SampleType>& chain, juce::AudioBuffer<SampleType>& buffer);
+
+    // Marks the parameter for reloading, and asks for the reported latency to follow the
+    // oversampling choice. Called on whichever thread moved the parameter, often the
+    // audio thread, so the latency itself is only reported from the message thread.
+    void parameterChanged(const juce::String& parameterID, float newValue) override;
+
+    // Reports the latency for the current oversampling choice and fold position, on the
+    // message thread like prepareToPlay(), which is what replaces the engine's filters
+    void handleAsyncUpdate() override;
     
     // Parameter initialization
     juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
@@ -0,0 +1,157 @@
+#include "PreDelay.h"
+
+template <typename SampleType>
+void PreDelay<SampleType>::prepare(const juce::dsp::ProcessSpec& spec, double maxDelaySeconds)
+{
+    sampleRate = spec.sampleRate;
+    maxBlockSize = (int) spec.maximumBlockSize;
+    maxDelayInSamples = (float) (maxDelaySeconds * sampleRate);
+
+    // The newest block plus the longest delay and one interpolation neighbour must fit
+    // without the writes catching up with the oldest read
+    const int capacity = juce::nextPowerOfTwo((int) std::ceil(maxDelayInSamples) + maxBlockSize + 2);
+    capacityMask = capacity - 1;
+
+    ring.setSize((int) spec.numChannels, capacity);
+    scratch.allocate((size_t) maxBlockSize + 1, true);
+
+    const float target = juce::jmin(delay.getTargetValue(), maxDelayInSamples);
+    delay.reset(sampleRate, rampSeconds);
+    delay.setCurrentAndTargetValue(target);
+    reset();
+}
+
+template <typename SampleType>
+void PreDelay<SampleType>::reset()
+{
+    ring.clear();
+    writePosition = 0;
+    delay.setCurrentAndTargetValue(delay.getTargetValue());
+    jumpToNextDelay = true;
+}
+
+template <typename SampleType>
+void PreDelay<SampleType>::setDelay(float milliseconds)
+{
+    const float samples = juce::jlimit(0.0f, maxDelayInSamples, milliseconds * 0.001f * (float) sampleRate);
+
+    if (jumpToNextDelay)
+    {
+        delay.setCurrentAndTargetValue(samples);
+        jumpToNextDelay = false;
+    }
+    else
+    {
+        delay.setTargetValue(samples);
+    }
+}
+
+template <typename SampleType>
+void PreDelay<SampleType>::process(const juce::dsp::AudioBlock<SampleType>& block)
+{
+    const int numChannels = juce::jmin((int) block.getNumChannels(), ring.getNumChannels());
+    const int numSamples = (int) block.getNumSamples();
+
+    jassert(numSamples <= maxBlockSize);
+    jumpToNextDelay = false;
+
+    const int blockStart = writePosition;
+
+    for (int channel = 0; channel < numChannels; ++channel)
+        writeBlock(channel, block.getChannelPointer((size_t) channel), numSamples);
+
+    writePosition = (writePosition + numSamples) & capacityMask;
+
+    // Resolve the glide for the whole block: the delay of its first sample and the step
+    const bool ramping = delay.isSmoothing();
+    const float startDelay = delay.getCurrentValue();
+    delay.skip(numSamples);
+    const float step = (delay.getCurrentValue() - startDelay) / (float) juce::jmax(1, numSamples);
+
+    if (! ramping)
+    {
+        // 0 ms bypass: the input is already in the ring for when the delay moves again
+        if (startDelay <= 0.0f)
+            return;
+
+        const int wholeDelay = (int) startDelay;
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            auto* output = block.getChannelPointer((size_t) channel);
+
+            if ((float) wholeDelay == startDelay)
+                readWhole(channel, blockStart, output, numSamples, wholeDelay);
+            else
+                readFractional(channel, blockStart, output, numSamples, startDelay);
+        }
+
+        return;
+    }
+
+    for (int channel = 0; channel < numChannels; ++channel)
+        readRamp(channel, blockStart, block.getChannelPointer((size_t) channel), numSamples, startDelay, step);
+}
+
+template <typename SampleType>
+void PreDelay<SampleType>::writeBlock(int channel, const SampleType* input, int numSamples)
+{
+    // Up to the end of the ring, then wrap to the start
+    SampleType* destination = ring.getWritePointer(channel);
+    const int firstRun = juce::jmin(numSamples, capacityMask + 1 - writePosition);
+
+    std::copy(input, input + firstRun, destination + writePosition);
+    std::copy(input + firstRun, input + numSamples, destination);
+}
+
+template <typename SampleType>
+void PreDelay<SampleType>::readRing(int channel, int startPosition, SampleType* output, int numSamples) const
+{
+    const SampleType* source = ring.getReadPointer(channel);
+    const int start = startPosition & capacityMask;
+    const int firstRun = juce::jmin(numSamples, capacityMask + 1 - start);
+
+    std::copy(source + start, source + start + firstRun, output);
+    std::copy(source, source + numSamples - firstRun, output + firstRun);
+}
+
+template <typename SampleType>
+void PreDelay<SampleType>::readWhole(int channel, int blockStart, SampleType* output, int numSamples, int delaySamples) const
+{
+    readRing(channel, blockStart - delaySamples, output, numSamples);
+}
+
+template <typename SampleType>
+void PreDelay<SampleType>::readFractional(int channel, int blockStart, SampleType* output, int numSamples, float delaySamples)
+{
+    // y[n] = x[n - d] * (1 - f) + x[n - d - 1] * f, with the older neighbour of the first
+    // sample at scratch[0]
+    const int wholeDelay = (int) delaySamples;
+    const float fraction = delaySamples - (float) wholeDelay;
+    SampleType* taps = scratch.getData();
+
+    readRing(channel, blockStart - wholeDelay - 1, taps, numSamples + 1);
+
+    for (int i = 0; i < numSamples; ++i)
+        output[i] = taps[i + 1] + fraction * (taps[i] - taps[i + 1]);
+}
+
+template <typename SampleType>
+void PreDelay<SampleType>::readRamp(int channel, int blockStart, SampleType* output, int numSamples, float startDelay, float step) const
+{
+    const SampleType* source = ring.getReadPointer(channel);
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const float delaySamples = startDelay + step * (float) i;
+        const int wholeDelay = (int) delaySamples;
+        const float fraction = delaySamples - (float) wholeDelay;
+
+        const SampleType newer = source[(blockStart + i - wholeDelay) & capacityMask];
+        const SampleType older = source[(blockStart + i - wholeDelay - 1) & capacityMask];
+        output[i] = newer + fraction * (older - newer);
+    }
+}
+
+template class PreDelay<float>;
+template class PreDelay<double>;
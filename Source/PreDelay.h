@@ -0,0 +1,60 @@
+#pragma once
+
+#include <juce_dsp/juce_dsp.h>
+
+// Block-based pre-delay on a power-of-two circular buffer.
+//
+// Each block is first written into the ring with at most two copies per channel, then
+// read back at the delay. A steady whole-sample delay is a plain copy out of the ring; a
+// steady fractional delay reads one extra sample and blends neighbours in a single
+// vectorisable pass; only while the delay is ramping does the read interpolate at a
+// per-sample position. At 0 ms the read is skipped altogether and the block passes
+// through untouched.
+//
+// The delay position is tracked in float for either sample type; only the audio path
+// (ring, taps and blend) runs at SampleType.
+//
+// Delay changes glide linearly over rampSeconds. The ramp is resolved once per block, as
+// a start delay and a per-sample step, so a steady delay pays nothing for it.
+template <typename SampleType>
+class PreDelay
+{
+public:
+    static constexpr double rampSeconds = 0.05;
+
+    PreDelay() = default;
+    ~PreDelay() = default;
+
+    void prepare(const juce::dsp::ProcessSpec& spec, double maxDelaySeconds);
+    void reset();
+
+    // The first delay after prepare() or reset() applies at once; later ones glide
+    void setDelay(float milliseconds);
+
+    // In place; the block must have at most as many channels and samples as prepared
+    void process(const juce::dsp::AudioBlock<SampleType>& block);
+
+private:
+    double sampleRate = 44100.0;
+    float maxDelayInSamples = 0.0f;
+    int maxBlockSize = 0;
+
+    juce::AudioBuffer<SampleType> ring;
+    int capacityMask = 0;
+    int writePosition = 0;
+
+    juce::SmoothedValue<float> delay;
+    bool jumpToNextDelay = true;
+
+    // maxBlockSize + 1 samples, for the two-tap fractional read
+    juce::HeapBlock<SampleType> scratch;
+
+    void writeBlock(int channel, const SampleType* input, int numSamples);
+    void readRing(int channel, int startPosition, SampleType* output, int numSamples) const;
+
+    void readWhole(int channel, int blockStart, SampleType* output, int numSamples, int delaySamples) const;
+    void readFractional(int channel, int blockStart, SampleType* output, int numSamples, float delaySamples);
+    void readRamp(int channel, int blockStart, SampleType* output, int numSamples, float startDelay, float step) const;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PreDelay)
+};
@@ -0,0 +1,206 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#if defined (_MSC_VER) && (defined (_M_X64) || defined (_M_IX86))
+ #include <intrin.h>
+#elif defined (__x86_64__) || defined (__i386__)
+ #include <x86intrin.h>
+#endif
+
+// Per-stage timing of the engine's process() calls, for development builds.
+//
+// Off unless WAVEFOLD_REVERB_STAGE_PROFILING is 1, which it is by default in debug builds.
+// With it at 0 this header declares nothing, the engine has no profiler member, and the
+// WAVEFOLD_REVERB_PROFILE_* macros expand to nothing, so release builds carry no trace
+// of it. Define it to 1 (e.g. the CMake option of the same name) to profile an
+// optimised build.
+#ifndef WAVEFOLD_REVERB_STAGE_PROFILING
+ #if JUCE_DEBUG
+  #define WAVEFOLD_REVERB_STAGE_PROFILING 1
+ #else
+  #define WAVEFOLD_REVERB_STAGE_PROFILING 0
+ #endif
+#endif
+
+#if WAVEFOLD_REVERB_STAGE_PROFILING
+
+// The audio thread marks the end of each stage with the CPU's cycle counter (the TSC on
+// x86, the virtual counter on ARM64, a steady clock elsewhere) and pushes one record per
+// process() call into a lock-free single-producer, single-consumer ring. A reader on
+// another thread (the editor's timer, a tool) pops them. When the reader falls behind,
+// records are dropped and counted rather than blocking the audio thread.
+class StageProfiler
+{
+public:
+    enum Stage
+    {
+        preDelayStage,  // input copy, dry path delay, pre-delay
+        preFoldStage,
+        diffusionStage,
+        reverbStage,    // includes the fold in the in-loop position
+        postFoldStage,
+        dcBlockStage,
+        eqStage,
+        convolutionStage, // the frozen reverb, with its handover
+        mixStage,
+        gateStage,      // input/output level checks and the sleep state
+        numStages
+    };
+
+    static const char* getStageName(int stage) noexcept
+    {
+        static const char* const names[] = { "Pre-delay", "Pre-fold", "Diffusion", "Reverb", "Post-fold", "DC block", "EQ", "Convolution", "Mix", "Gate" };
+        return juce::isPositiveAndBelow(stage, (int) numStages) ? names[stage] : "";
+    }
+
+    // Counter ticks spent in each stage over one process() call
+    struct BlockTiming
+    {
+        std::array<juce::uint64, numStages> ticks {};
+        int numSamples = 0;
+        double sampleRate = 0.0;
+    };
+
+    static juce::uint64 now() noexcept
+    {
+       #if defined (_MSC_VER) && (defined (_M_X64) || defined (_M_IX86))
+        return __rdtsc();
+       #elif defined (__x86_64__) || defined (__i386__)
+        return __rdtsc();
+       #elif defined (__aarch64__)
+        juce::uint64 value;
+        asm volatile ("mrs %0, cntvct_el0" : "=r" (value));
+        return value;
+       #else
+        return (juce::uint64) std::chrono::steady_clock::now().time_since_epoch().count();
+       #endif
+    }
+
+    // Counter rate, measured once against the steady clock. Takes ~20 ms the first time,
+    // so call it from the reader, never from the audio thread.
+    static double getTicksPerSecond()
+    {
+        static const double ticksPerSecond = []
+        {
+            const auto clockStart = std::chrono::steady_clock::now();
+            const auto tickStart = now();
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            const auto tickEnd = now();
+            const auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - clockStart).count();
+            return (double) (tickEnd - tickStart) / seconds;
+        }();
+
+        return ticksPerSecond;
+    }
+
+    //==============================================================================
+    // Audio thread
+
+    void beginBlock(double sampleRate) noexcept
+    {
+        current = {};
+        current.sampleRate = sampleRate;
+        lastMark = now();
+    }
+
+    // Charges everything since the previous mark to this stage
+    void endStage(Stage stage) noexcept
+    {
+        const auto tick = now();
+        current.ticks[(size_t) stage] += tick - lastMark;
+        lastMark = tick;
+    }
+
+    void endBlock(int numSamples) noexcept
+    {
+        current.numSamples = numSamples;
+
+        const auto write = writeIndex.load(std::memory_order_relaxed);
+
+        if (write - readIndex.load(std::memory_order_acquire) == (juce::uint32) capacity)
+        {
+            droppedBlocks.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        ring[write & (capacity - 1)] = current;
+        writeIndex.store(write + 1, std::memory_order_release);
+    }
+
+    //==============================================================================
+    // Reader
+
+    // Copies out up to maxBlocks of the oldest records and returns how many
+    int pop(BlockTiming* destination, int maxBlocks) noexcept
+    {
+        const auto read = readIndex.load(std::memory_order_relaxed);
+        const auto available = (int) (writeIndex.load(std::memory_order_acquire) - read);
+        const int count = juce::jmin(available, maxBlocks);
+
+        for (int i = 0; i < count; ++i)
+            destination[i] = ring[(read + (juce::uint32) i) & (capacity - 1)];
+
+        readIndex.store(read + (juce::uint32) count, std::memory_order_release);
+        return count;
+    }
+
+    juce::uint32 getDroppedBlocks() const noexcept { return droppedBlocks.load(std::memory_order_relaxed); }
+
+    // One row per block: the counter ticks of every stage, plus the block's length and
+    // the counter rate so each row converts to seconds and CPU load on its own
+    static juce::String toCsv(const BlockTiming* timings, int numBlocks)
+    {
+        static_assert (numStages == 10, "Keep the CSV header in step with the stages");
+        juce::String csv("block,samples,sampleRate,ticksPerSecond,"
+                         "preDelayTicks,preFoldTicks,diffusionTicks,reverbTicks,postFoldTicks,dcBlockTicks,eqTicks,convolutionTicks,mixTicks,gateTicks\n");
+
+        const auto ticksPerSecond = juce::String(getTicksPerSecond(), 0);
+
+        for (int block = 0; block < numBlocks; ++block)
+        {
+            const auto& timing = timings[block];
+            csv << block << "," << timing.numSamples << "," << juce::String(timing.sampleRate, 0) << "," << ticksPerSecond;
+
+            for (auto ticks : timing.ticks)
+                csv << "," << juce::String((juce::int64) ticks);
+
+            csv << "\n";
+        }
+
+        return csv;
+    }
+
+private:
+    static constexpr int capacity = 1024; // power of two
+
+    // Audio thread only
+    BlockTiming current;
+    juce::uint64 lastMark = 0;
+
+    std::array<BlockTiming, capacity> ring;
+
+    // Each index on its own cache line, so the two threads don't share one
+    alignas (64) std::atomic<juce::uint32> writeIndex { 0 };
+    alignas (64) std::atomic<juce::uint32> readIndex { 0 };
+    std::atomic<juce::uint32> droppedBlocks { 0 };
+};
+
+ #define WAVEFOLD_REVERB_PROFILE_BEGIN(profiler, sampleRate) \
+    do { if ((profiler) != nullptr) (profiler)->beginBlock(sampleRate); } while (false)
+ #define WAVEFOLD_REVERB_PROFILE_STAGE(profiler, stage) \
+    do { if ((profiler) != nullptr) (profiler)->endStage(StageProfiler::stage); } while (false)
+ #define WAVEFOLD_REVERB_PROFILE_END(profiler, numSamples) \
+    do { if ((profiler) != nullptr) (profiler)->endBlock(numSamples); } while (false)
+
+#else
+
+ #define WAVEFOLD_REVERB_PROFILE_BEGIN(profiler, sampleRate)
+ #define WAVEFOLD_REVERB_PROFILE_STAGE(profiler, stage)
+ #define WAVEFOLD_REVERB_PROFILE_END(profiler, numSamples)
+
+#endif
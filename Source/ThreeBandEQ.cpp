@@ -0,0 +1,176 @@
+#include "ThreeBandEQ.h"
+
+namespace
+{
+    // Butterworth sections, so each low/high-pass pair sums to an allpass
+    constexpr double damping = juce::MathConstants<double>::sqrt2;
+
+    template <typename SIMDType>
+    struct SectionOutputs
+    {
+        SIMDType band, low;
+    };
+
+    // One step of a TPT state-variable filter: returns the band-pass and low-pass
+    // outputs, from which high-pass and allpass follow
+    template <typename SIMDType, typename State, typename Coefficients>
+    inline SectionOutputs<SIMDType> tick(State& state, const Coefficients& c, SIMDType input) noexcept
+    {
+        const auto v3 = input - state.ic2;
+        const auto v1 = c.a1 * state.ic1 + c.a2 * v3;
+        const auto v2 = state.ic2 + c.a2 * state.ic1 + c.a3 * v3;
+        state.ic1 = v1 + v1 - state.ic1;
+        state.ic2 = v2 + v2 - state.ic2;
+        return { v1, v2 };
+    }
+}
+
+template <typename SampleType>
+typename ThreeBandEQ<SampleType>::Coefficients ThreeBandEQ<SampleType>::makeCoefficients(double frequency, double sampleRate) noexcept
+{
+    const double g = std::tan(juce::MathConstants<double>::pi * juce::jmin(frequency, 0.45 * sampleRate) / sampleRate);
+    const double a1 = 1.0 / (1.0 + g * (g + damping));
+    const double a2 = g * a1;
+    const double a3 = g * a2;
+
+    return { SIMDType::expand((SampleType) a1), SIMDType::expand((SampleType) a2), SIMDType::expand((SampleType) a3) };
+}
+
+template <typename SampleType>
+void ThreeBandEQ<SampleType>::prepare(double sampleRate, int numChannels)
+{
+    lowCoefficients = makeCoefficients(lowCrossoverHz, sampleRate);
+    highCoefficients = makeCoefficients(highCrossoverHz, sampleRate);
+
+    numChannelsPrepared = juce::jmax(1, numChannels);
+    numRegisters = (numChannelsPrepared + simdWidth - 1) / simdWidth;
+    frameSize = numRegisters * simdWidth;
+
+    states.resize((size_t) numRegisters);
+    gainsSet = false;
+    reset();
+
+    frameStorage.calloc((size_t) (chunkSize * frameSize + simdWidth));
+    frames = SIMDType::getNextSIMDAlignedPtr(frameStorage.getData());
+}
+
+template <typename SampleType>
+void ThreeBandEQ<SampleType>::reset()
+{
+    const SectionState silence { SIMDType::expand(0), SIMDType::expand(0) };
+
+    for (auto& state : states)
+        state.fill(silence);
+
+    gains = targetGains;
+}
+
+template <typename SampleType>
+void ThreeBandEQ<SampleType>::setGains(SampleType lowDecibels, SampleType midDecibels, SampleType highDecibels) noexcept
+{
+    targetGains = { juce::Decibels::decibelsToGain(lowDecibels, (SampleType) -120),
+                    juce::Decibels::decibelsToGain(midDecibels, (SampleType) -120),
+                    juce::Decibels::decibelsToGain(highDecibels, (SampleType) -120) };
+
+    if (! gainsSet)
+    {
+        gains = targetGains;
+        gainsSet = true;
+    }
+}
+
+template <typename SampleType>
+void ThreeBandEQ<SampleType>::process(const juce::dsp::AudioBlock<SampleType>& block) noexcept
+{
+    const int numChannels = juce::jmin((int) block.getNumChannels(), numChannelsPrepared);
+    const int numSamples = (int) block.getNumSamples();
+
+    if (frames == nullptr || numChannels == 0 || numSamples == 0)
+        return;
+
+    const auto k = SIMDType::expand((SampleType) damping);
+    const auto twoK = SIMDType::expand((SampleType) (2.0 * damping));
+
+    // Gains ramp linearly from where the last block ended to the target
+    std::array<SampleType, 3> gainSteps;
+
+    for (size_t band = 0; band < gains.size(); ++band)
+        gainSteps[band] = (targetGains[band] - gains[band]) / (SampleType) numSamples;
+
+    const bool ramping = gains != targetGains;
+    auto lowGain = SIMDType::expand(targetGains[0]);
+    auto midGain = SIMDType::expand(targetGains[1]);
+    auto highGain = SIMDType::expand(targetGains[2]);
+
+    for (int start = 0; start < numSamples; start += chunkSize)
+    {
+        const int length = juce::jmin(chunkSize, numSamples - start);
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            const SampleType* input = block.getChannelPointer((size_t) channel) + start;
+
+            for (int t = 0; t < length; ++t)
+                frames[t * frameSize + channel] = input[t];
+        }
+
+        // Prepared channels missing from this block see silence; the padding lanes
+        // beyond them are never written and stay zero
+        for (int channel = numChannels; channel < numChannelsPrepared; ++channel)
+            for (int t = 0; t < length; ++t)
+                frames[t * frameSize + channel] = 0;
+
+        for (int t = 0; t < length; ++t)
+        {
+            if (ramping)
+            {
+                const auto position = (SampleType) (start + t + 1);
+                lowGain = SIMDType::expand(gains[0] + gainSteps[0] * position);
+                midGain = SIMDType::expand(gains[1] + gainSteps[1] * position);
+                highGain = SIMDType::expand(gains[2] + gainSteps[2] * position);
+            }
+
+            SampleType* frame = frames + t * frameSize;
+
+            for (int r = 0; r < numRegisters; ++r)
+            {
+                auto& state = states[(size_t) r];
+                const auto input = SIMDType::fromRawArray(frame + r * simdWidth);
+
+                // Lower crossover: the low band, and the rest for the upper one
+                const auto split = tick(state[lowSplit], lowCoefficients, input);
+                const auto low = tick(state[lowPass], lowCoefficients, split.low).low;
+                const auto restHighPass = input - k * split.band - split.low;
+                const auto restSection = tick(state[lowRest], lowCoefficients, restHighPass);
+                const auto rest = restHighPass - k * restSection.band - restSection.low;
+
+                // Upper crossover: mid and high bands
+                const auto upperSplit = tick(state[highSplit], highCoefficients, rest);
+                const auto mid = tick(state[midPass], highCoefficients, upperSplit.low).low;
+                const auto upperHighPass = rest - k * upperSplit.band - upperSplit.low;
+                const auto highSection = tick(state[highPass], highCoefficients, upperHighPass);
+                const auto high = upperHighPass - k * highSection.band - highSection.low;
+
+                // The mid and high bands passed the upper crossover, which summed is an
+                // allpass; the low band gets the same one
+                const auto alignedLow = low - twoK * tick(state[lowAllpass], highCoefficients, low).band;
+
+                const auto output = lowGain * alignedLow + midGain * mid + highGain * high;
+                output.copyToRawArray(frame + r * simdWidth);
+            }
+        }
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            SampleType* output = block.getChannelPointer((size_t) channel) + start;
+
+            for (int t = 0; t < length; ++t)
+                output[t] = frames[t * frameSize + channel];
+        }
+    }
+
+    gains = targetGains;
+}
+
+template class ThreeBandEQ<float>;
+template class ThreeBandEQ<double>;
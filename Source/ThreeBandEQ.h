@@ -0,0 +1,81 @@
+#pragma once
+
+#include <juce_dsp/juce_dsp.h>
+#include <array>
+#include <vector>
+
+// Three-band tone control for the wet path: fourth-order Linkwitz-Riley crossovers at
+// lowCrossoverHz and highCrossoverHz split each channel into low, mid and high bands,
+// which are scaled and summed. The low band runs through the upper crossover's allpass
+// so all three bands stay in phase, and with every gain at 0 dB the output is the input
+// through a flat-magnitude allpass.
+//
+// Each Linkwitz-Riley pair is built from Butterworth state-variable filters (TPT form),
+// which give the low-pass, high-pass and allpass outputs of one section at once: seven
+// sections per channel cover the whole split. As in DCBlocker, the recursion is
+// vectorised across channels: chunks are transposed into frames, every SIMD register
+// steps a group of channels through all seven sections together, and the result is
+// transposed back.
+template <typename SampleType>
+class ThreeBandEQ
+{
+public:
+    ThreeBandEQ() = default;
+    ~ThreeBandEQ() = default;
+
+    static constexpr double lowCrossoverHz = 300.0;
+    static constexpr double highCrossoverHz = 3000.0;
+
+    // Computes the crossover coefficients, which depend only on the sample rate
+    void prepare(double sampleRate, int numChannels);
+    void reset();
+
+    // Band gains in decibels. The first call after prepare() takes effect at once; later
+    // changes ramp across the next process() call, or land at once on reset().
+    void setGains(SampleType lowDecibels, SampleType midDecibels, SampleType highDecibels) noexcept;
+
+    // In place, on at most the prepared number of channels
+    void process(const juce::dsp::AudioBlock<SampleType>& block) noexcept;
+
+private:
+    using SIMDType = juce::dsp::SIMDRegister<SampleType>;
+    static constexpr int simdWidth = (int) SIMDType::SIMDNumElements;
+    static constexpr int chunkSize = 64;
+
+    // Lower split, its two Linkwitz-Riley halves, upper split, its two halves, and the
+    // low band's phase compensation
+    enum Section { lowSplit, lowPass, lowRest, highSplit, midPass, highPass, lowAllpass, numSections };
+
+    struct Coefficients
+    {
+        SIMDType a1, a2, a3;
+    };
+
+    struct SectionState
+    {
+        SIMDType ic1, ic2;
+    };
+
+    using RegisterState = std::array<SectionState, numSections>;
+
+    static Coefficients makeCoefficients(double frequency, double sampleRate) noexcept;
+
+    Coefficients lowCoefficients, highCoefficients;
+
+    int numChannelsPrepared = 0;
+    int numRegisters = 0;
+    int frameSize = 0; // channels rounded up to whole registers
+
+    std::vector<RegisterState> states;
+
+    // Linear gains: where the ramp starts in the next process() call, and where it ends
+    std::array<SampleType, 3> gains { 1, 1, 1 };
+    std::array<SampleType, 3> targetGains { 1, 1, 1 };
+    bool gainsSet = false;
+
+    // chunkSize frames, SIMD aligned
+    juce::HeapBlock<SampleType> frameStorage;
+    SampleType* frames = nullptr;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ThreeBandEQ)
+};
@@ -0,0 +1,678 @@
+#include "WavefoldReverbEngine.h"
+
+WavefoldReverbEngineBase::ParameterMask WavefoldReverbEngineBase::getChangedParameters(const Parameters& oldParameters,
+                                                                                       const Parameters& newParameters)
+{
+    ParameterMask changed = 0;
+
+    auto compare = [&changed] (auto oldValue, auto newValue, ParameterMask flag)
+    {
+        if (oldValue != newValue)
+            changed |= flag;
+    };
+
+    // Reverb parameters
+    compare(oldParameters.size, newParameters.size, sizeFlag);
+    compare(oldParameters.decay, newParameters.decay, decayFlag);
+    compare(oldParameters.diffusion, newParameters.diffusion, diffusionFlag);
+    compare(oldParameters.density, newParameters.density, densityFlag);
+    compare(oldParameters.lowEQ, newParameters.lowEQ, lowEQFlag);
+    compare(oldParameters.midEQ, newParameters.midEQ, midEQFlag);
+    compare(oldParameters.highEQ, newParameters.highEQ, highEQFlag);
+
+    // Wavefolder parameters
+    compare(oldParameters.drive, newParameters.drive, driveFlag);
+    compare(oldParameters.threshold, newParameters.threshold, thresholdFlag);
+    compare(oldParameters.offset, newParameters.offset, offsetFlag);
+    compare(oldParameters.fundamental, newParameters.fundamental, fundamentalFlag);
+    compare(oldParameters.foldSymmetry, newParameters.foldSymmetry, foldSymmetryFlag);
+    compare(oldParameters.waveformShape, newParameters.waveformShape, waveformShapeFlag);
+
+    // Additional parameters
+    compare(oldParameters.dryWet, newParameters.dryWet, dryWetFlag);
+    compare(oldParameters.preDelay, newParameters.preDelay, preDelayFlag);
+    compare(oldParameters.wavefoldPosition, newParameters.wavefoldPosition, wavefoldPositionFlag);
+    compare(oldParameters.oversampling, newParameters.oversampling, oversamplingFlag);
+    compare(oldParameters.antialiasing, newParameters.antialiasing, antialiasingFlag);
+    compare(oldParameters.fdnLines, newParameters.fdnLines, fdnLinesFlag);
+    compare(oldParameters.foldMode, newParameters.foldMode, foldModeFlag);
+    compare(oldParameters.reverbMode, newParameters.reverbMode, reverbModeFlag);
+
+    return changed;
+}
+
+bool WavefoldReverbEngineBase::setParameter(Parameters& parameters, const juce::String& parameterID, float value)
+{
+    struct FloatField { const char* id; float Parameters::* field; };
+    struct ChoiceField { const char* id; int Parameters::* field; };
+
+    static const FloatField floatFields[] = {
+        { "size", &Parameters::size }, { "decay", &Parameters::decay },
+        { "diffusion", &Parameters::diffusion }, { "density", &Parameters::density },
+        { "lowEQ", &Parameters::lowEQ }, { "midEQ", &Parameters::midEQ }, { "highEQ", &Parameters::highEQ },
+        { "drive", &Parameters::drive }, { "threshold", &Parameters::threshold },
+        { "offset", &Parameters::offset }, { "fundamental", &Parameters::fundamental },
+        { "foldSymmetry", &Parameters::foldSymmetry }, { "waveformShape", &Parameters::waveformShape },
+        { "dryWet", &Parameters::dryWet }, { "preDelay", &Parameters::preDelay }
+    };
+
+    static const ChoiceField choiceFields[] = {
+        { "wavefoldPosition", &Parameters::wavefoldPosition }, { "oversampling", &Parameters::oversampling },
+        { "antialiasing", &Parameters::antialiasing }, { "fdnLines", &Parameters::fdnLines },
+        { "foldMode", &Parameters::foldMode }, { "reverbMode", &Parameters::reverbMode }
+    };
+
+    for (const auto& entry : floatFields)
+    {
+        if (parameterID == entry.id)
+        {
+            parameters.*entry.field = value;
+            return true;
+        }
+    }
+
+    for (const auto& entry : choiceFields)
+    {
+        if (parameterID == entry.id)
+        {
+            parameters.*entry.field = juce::roundToInt(value);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+template <typename SampleType>
+BasicWavefoldReverbEngine<SampleType>::BasicWavefoldReverbEngine()
+    : frozenReverb([this] (auto& responses, double sampleRate, bool withMono) { renderImpulseResponses(responses, sampleRate, withMono); })
+{
+}
+
+template <typename SampleType>
+void BasicWavefoldReverbEngine<SampleType>::prepare(const juce::dsp::ProcessSpec& spec)
+{
+    // First, so a capture in progress has finished before anything it reads changes
+    if (! isCaptureEngine)
+        frozenReverb.prepare(spec);
+
+    currentSampleRate = spec.sampleRate;
+    const int samplesPerBlock = (int) spec.maximumBlockSize;
+    const int numChannels = (int) spec.numChannels;
+
+    // Set up pre-delay
+    preDelay.prepare(spec, 0.5); // Max 500ms pre-delay
+
+    // Set up the diffusion ahead of the reverb, starting at the density's tier rather
+    // than fading into it
+    inputDiffuser.setDensity(params.density);
+    inputDiffuser.prepare(spec);
+
+    // Set up reverb: one instance per channel pair
+    const int numPairs = (juce::jmax(1, numChannels) + 1) / 2;
+    reverbs.clear();
+    feedbackNetworks.clear();
+
+    for (int pair = 0; pair < numPairs; ++pair)
+    {
+        reverbs.push_back(std::make_unique<CombBankReverb<SampleType>>());
+        feedbackNetworks.push_back(std::make_unique<FeedbackDelayNetwork<SampleType>>());
+    }
+
+    // Parameters first, so prepare() starts the smoothing at their values
+    updateReverbParameters();
+
+    for (int pair = 0; pair < numPairs; ++pair)
+    {
+        const auto pairSpec = juce::dsp::ProcessSpec { spec.sampleRate, spec.maximumBlockSize,
+                                                       (juce::uint32) juce::jmin(2, numChannels - 2 * pair) };
+        reverbs[(size_t) pair]->prepare(pairSpec);
+        feedbackNetworks[(size_t) pair]->prepare(pairSpec);
+    }
+
+    // Set up wavefolder
+    wavefolder.prepare(spec);
+
+    if (params.foldMode == 1)
+        wavefolder.prepareLookupTable();
+
+    // Set up the fold oversampling and the matching dry path delay
+    int maxLatency = 0;
+
+    for (size_t i = 0; i < oversamplers.size(); ++i)
+    {
+        oversamplers[i] = std::make_unique<juce::dsp::Oversampling<SampleType>>(
+            (size_t) numChannels, i + 1, juce::dsp::Oversampling<SampleType>::filterHalfBandPolyphaseIIR, true, true);
+        oversamplers[i]->initProcessing((size_t) samplesPerBlock);
+        maxLatency = juce::jmax(maxLatency, getOversamplerLatency((int) i + 1));
+    }
+
+    dryDelay.prepare(spec);
+    dryDelay.setMaximumDelayInSamples(juce::jmax(1, maxLatency));
+    activeOversampling = -1;
+
+    dcBlocker.prepare(numChannels);
+    toneEQ.prepare(spec.sampleRate, numChannels);
+
+    // Everything derived from the parameters starts from the current snapshot
+    applyParameters(allParameters);
+
+    // Prepare the wet path's scratch buffer
+    wetBuffer.setSize(numChannels, samplesPerBlock);
+}
+
+template <typename SampleType>
+void BasicWavefoldReverbEngine<SampleType>::reset()
+{
+    preDelay.reset();
+    dryDelay.reset();
+    inputDiffuser.reset();
+
+    for (auto& oversampler : oversamplers)
+        if (oversampler != nullptr)
+            oversampler->reset();
+
+    for (auto& pairReverb : reverbs)
+        pairReverb->reset();
+
+    for (auto& network : feedbackNetworks)
+        network->reset();
+
+    wavefolder.reset();
+    dcBlocker.reset();
+    toneEQ.reset();
+    frozenReverb.reset();
+
+    silenceCounter = 0;
+    silentInputSamples = 0;
+    sleeping = false;
+}
+
+template <typename SampleType>
+void BasicWavefoldReverbEngine<SampleType>::setParameters(const Parameters& newParameters)
+{
+    setParameters(newParameters, getChangedParameters(params, newParameters));
+}
+
+template <typename SampleType>
+void BasicWavefoldReverbEngine<SampleType>::setParameters(const Parameters& newParameters, ParameterMask changedParameters)
+{
+    params = newParameters;
+    applyParameters(changedParameters);
+}
+
+template <typename SampleType>
+void BasicWavefoldReverbEngine<SampleType>::applyParameters(ParameterMask changedParameters)
+{
+    // The fold amount, position, mix and fundamental are read straight from params
+    // every block; only these feed derived state
+    constexpr ParameterMask reverbFlags = sizeFlag | decayFlag | diffusionFlag | fdnLinesFlag;
+    constexpr ParameterMask vectorFoldFlags = driveFlag | thresholdFlag | offsetFlag | foldSymmetryFlag | waveformShapeFlag;
+    constexpr ParameterMask eqFlags = lowEQFlag | midEQFlag | highEQFlag;
+
+    if ((changedParameters & reverbFlags) != 0)
+        updateReverbParameters();
+
+    if ((changedParameters & eqFlags) != 0)
+        updateEQ();
+
+    if ((changedParameters & densityFlag) != 0)
+        inputDiffuser.setDensity(params.density);
+
+    // Moving the fold into the loop turns its oversampling off, and back out turns it on
+    if ((changedParameters & (oversamplingFlag | wavefoldPositionFlag)) != 0)
+        updateOversampling();
+
+    if ((changedParameters & preDelayFlag) != 0)
+        preDelay.setDelay(params.preDelay);
+
+    if ((changedParameters & antialiasingFlag) != 0)
+        wavefolder.setAntialiasingOrder(params.antialiasing);
+
+    if ((changedParameters & foldModeFlag) != 0)
+        wavefolder.setLookupTableEnabled(params.foldMode == 1);
+
+    // The in-loop fold's constants and kernel
+    if ((changedParameters & vectorFoldFlags) != 0)
+        wavefolder.setVectorFoldParameters(params.drive, params.threshold, params.offset,
+                                           params.foldSymmetry, params.waveformShape);
+
+    updateFrozenReverb(changedParameters);
+}
+
+template <typename SampleType>
+int BasicWavefoldReverbEngine<SampleType>::getOversamplingChoice(const Parameters& parameters) noexcept
+{
+    if (parameters.wavefoldPosition == IN_REVERB_LOOP)
+        return 0;
+
+    return juce::jlimit(0, maxOversamplingOrder, parameters.oversampling);
+}
+
+template <typename SampleType>
+int BasicWavefoldReverbEngine<SampleType>::getLatencyInSamples(const Parameters& parameters) const
+{
+    return getOversamplerLatency(getOversamplingChoice(parameters));
+}
+
+template <typename SampleType>
+int BasicWavefoldReverbEngine<SampleType>::getOversamplerLatency(int oversamplingChoice) const
+{
+    if (oversamplingChoice <= 0 || oversamplingChoice > maxOversamplingOrder)
+        return 0;
+
+    const auto& oversampler = oversamplers[(size_t) oversamplingChoice - 1];
+    return oversampler != nullptr ? juce::roundToInt(oversampler->getLatencyInSamples()) : 0;
+}
+
+template <typename SampleType>
+double BasicWavefoldReverbEngine<SampleType>::getTailLengthSeconds(const Parameters& parameters) const
+{
+    const double gateDecibels = -juce::Decibels::gainToDecibels(noiseGateThreshold);
+    double reverbTail;
+
+    if (parameters.wavefoldPosition == IN_REVERB_LOOP)
+    {
+        typename FeedbackDelayNetwork<SampleType>::Parameters networkParams;
+        networkParams.roomSize = parameters.size;
+        networkParams.decaySeconds = parameters.decay;
+        reverbTail = FeedbackDelayNetwork<SampleType>::getTailLengthSeconds(networkParams, gateDecibels);
+    }
+    else
+    {
+        juce::Reverb::Parameters combParams;
+        combParams.roomSize = parameters.size;
+        reverbTail = CombBankReverb<SampleType>::getTailLengthSeconds(combParams, gateDecibels);
+    }
+
+    return parameters.preDelay * 0.001 + getLatencyInSamples(parameters) / currentSampleRate
+         + InputDiffuser<SampleType>::getTailLengthSeconds(parameters.density, gateDecibels) + reverbTail;
+}
+
+template <typename SampleType>
+void BasicWavefoldReverbEngine<SampleType>::updateOversampling()
+{
+    const int choice = getOversamplingChoice(params);
+
+    if (choice == activeOversampling)
+        return;
+
+    // The newly selected filters and the dry delay start from silence
+    if (choice > 0 && oversamplers[(size_t) choice - 1] != nullptr)
+        oversamplers[(size_t) choice - 1]->reset();
+
+    dryDelay.reset();
+    dryDelay.setDelay((SampleType) getOversamplerLatency(choice));
+    activeOversampling = choice;
+}
+
+template <typename SampleType>
+void BasicWavefoldReverbEngine<SampleType>::updateReverbParameters()
+{
+    reverbParams.roomSize = params.size;
+    reverbParams.damping = 1.0f - params.decay / 20.0f; // Convert decay time to damping
+
+    // Ensure damping isn't too low at high decay values
+    // Apply a minimum damping value
+    if (reverbParams.damping < 0.05f)
+            reverbParams.damping = 0.05f;
+
+    reverbParams.width = params.diffusion;
+    reverbParams.wetLevel = 1.0f; // Handle dry/wet separately
+    reverbParams.dryLevel = 0.0f; // Handle dry/wet separately
+
+    for (auto& pairReverb : reverbs)
+        pairReverb->setParameters(reverbParams);
+
+    // The in-loop network follows the same controls, with decay as its RT60
+    typename FeedbackDelayNetwork<SampleType>::Parameters networkParams;
+    networkParams.numLines = params.fdnLines == 1 ? 16 : 8;
+    networkParams.roomSize = params.size;
+    networkParams.decaySeconds = params.decay;
+    networkParams.damping = reverbParams.damping;
+    networkParams.width = params.diffusion;
+
+    for (auto& network : feedbackNetworks)
+        network->setParameters(networkParams);
+}
+
+template <typename SampleType>
+void BasicWavefoldReverbEngine<SampleType>::updateEQ()
+{
+    // The crossovers are fixed at prepare(); only the band gains follow the parameters
+    auto toDecibels = [] (float value) { return (SampleType) ((juce::jlimit(0.0f, 1.0f, value) * 2.0f - 1.0f) * maxEQDecibels); };
+
+    toneEQ.setGains(toDecibels(params.lowEQ), toDecibels(params.midEQ), toDecibels(params.highEQ));
+}
+
+template <typename SampleType>
+void BasicWavefoldReverbEngine<SampleType>::updateFrozenReverb(ParameterMask changedParameters)
+{
+    // Everything but the mix and the fundamental shapes the wet path, so anything else
+    // moving makes the captured response stale
+    constexpr ParameterMask captureFlags = allParameters & ~(dryWetFlag | reverbModeFlag | fundamentalFlag);
+
+    if ((changedParameters & captureFlags) != 0)
+    {
+        frozenReverb.invalidate();
+        frozenReverb.setLiveTailSamples((int) std::ceil(getTailLengthSeconds() * currentSampleRate));
+    }
+
+    // The in-loop fold makes the network nonlinear at any level, so it stays live
+    if ((changedParameters & (reverbModeFlag | wavefoldPositionFlag)) != 0)
+        frozenReverb.setFrozen(params.reverbMode == 1 && params.wavefoldPosition != IN_REVERB_LOOP);
+}
+
+template <typename SampleType>
+void BasicWavefoldReverbEngine<SampleType>::renderImpulseResponses(typename FrozenReverb<SampleType>::ImpulseResponses& responses,
+                                                                   double sampleRate, bool withMono) const
+{
+    // Capture thread. Fully wet, since sin(pi / 2) rounds to 1, and always live
+    const auto parameters = getCaptureParameters(captureParameters);
+
+    // Always in double: the reverb's undenormalising rounds float signals to about 1e-8,
+    // which would leave a quiet impulse's response only ~40 dB clean
+    using CaptureEngine = BasicWavefoldReverbEngine<double>;
+
+    constexpr int captureBlockSize = 512;
+    const auto level = (double) FrozenReverb<SampleType>::captureLevel;
+
+    auto makeEngine = [&] (int numChannels)
+    {
+        auto engine = std::make_unique<CaptureEngine>();
+        engine->isCaptureEngine = true;
+        engine->params = parameters;
+        engine->prepare({ sampleRate, (juce::uint32) captureBlockSize, (juce::uint32) numChannels });
+        return engine;
+    };
+
+    // Renders an impulse into one channel (none for the baseline) from a clean state
+    auto render = [level] (CaptureEngine& engine, int impulseChannel, int length, juce::AudioBuffer<double>& output)
+    {
+        output.setSize(engine.wetBuffer.getNumChannels(), length);
+        output.clear();
+
+        if (impulseChannel >= 0)
+            output.setSample(impulseChannel, 0, level);
+
+        engine.reset();
+        engine.process(output);
+    };
+
+    // The response is what the impulse adds to the render of silence, e.g. the fold's
+    // offset decaying through the DC blocker, scaled back up to unit level
+    auto subtract = [level] (const juce::AudioBuffer<double>& impulse, const juce::AudioBuffer<double>& baseline,
+                             juce::AudioBuffer<float>& response)
+    {
+        response.setSize(impulse.getNumChannels(), impulse.getNumSamples());
+
+        for (int channel = 0; channel < impulse.getNumChannels(); ++channel)
+        {
+            const double* withImpulse = impulse.getReadPointer(channel);
+            const double* withoutImpulse = baseline.getReadPointer(channel);
+            float* destination = response.getWritePointer(channel);
+
+            for (int sample = 0; sample < impulse.getNumSamples(); ++sample)
+                destination[sample] = (float) ((withImpulse[sample] - withoutImpulse[sample]) / level);
+        }
+    };
+
+    juce::AudioBuffer<double> baseline, impulse;
+
+    auto stereo = makeEngine(2);
+    const double seconds = juce::jmin(stereo->getTailLengthSeconds(), FrozenReverb<SampleType>::maxCaptureSeconds);
+    const int length = juce::jmax(1, (int) std::ceil(seconds * sampleRate));
+
+    render(*stereo, -1, length, baseline);
+    render(*stereo, 0, length, impulse);
+    subtract(impulse, baseline, responses.fromLeft);
+    render(*stereo, 1, length, impulse);
+    subtract(impulse, baseline, responses.fromRight);
+
+    // An odd last channel runs the mono reverb, so it gets its own response
+    if (withMono)
+    {
+        auto single = makeEngine(1);
+        render(*single, -1, length, baseline);
+        render(*single, 0, length, impulse);
+        subtract(impulse, baseline, responses.mono);
+    }
+}
+
+template <typename SampleType>
+typename BasicWavefoldReverbEngine<SampleType>::Parameters
+    BasicWavefoldReverbEngine<SampleType>::getCaptureParameters(const Parameters& parameters) noexcept
+{
+    auto normalised = parameters;
+    normalised.dryWet = 1.0f;
+    normalised.reverbMode = 0;
+    normalised.fundamental = Parameters().fundamental;
+    return normalised;
+}
+
+template <typename SampleType>
+void BasicWavefoldReverbEngine<SampleType>::applyWavefolding(juce::dsp::AudioBlock<SampleType>& block)
+{
+    // Use custom wavefolder class, at the oversampled rate when enabled
+    if (activeOversampling > 0)
+    {
+        auto& oversampler = *oversamplers[(size_t) activeOversampling - 1];
+        auto upsampled = oversampler.processSamplesUp(block);
+        wavefolder.processBlock(upsampled, params.drive, params.threshold, params.offset,
+                                params.foldSymmetry, params.waveformShape, params.fundamental);
+        oversampler.processSamplesDown(block);
+    }
+    else
+    {
+        wavefolder.processBlock(block, params.drive, params.threshold, params.offset,
+                                params.foldSymmetry, params.waveformShape, params.fundamental);
+    }
+}
+
+template <typename SampleType>
+juce::dsp::AudioBlock<SampleType> BasicWavefoldReverbEngine<SampleType>::getChannelPair(const juce::dsp::AudioBlock<SampleType>& block, int pair)
+{
+    const auto firstChannel = (size_t) pair * 2;
+    return block.getSubsetChannelBlock(firstChannel, juce::jmin((size_t) 2, block.getNumChannels() - firstChannel));
+}
+
+template <typename SampleType>
+void BasicWavefoldReverbEngine<SampleType>::process(juce::AudioBuffer<SampleType>& buffer)
+{
+    // Hosts may send more than prepare()'s maximum block size. The scratch buffer and
+    // the oversampling filters are only sized for that, so longer blocks run in pieces.
+    const int maxChunkSize = wetBuffer.getNumSamples();
+
+    if (maxChunkSize <= 0)
+    {
+        jassertfalse; // process() before prepare()
+        return;
+    }
+
+    WAVEFOLD_REVERB_PROFILE_BEGIN(profiler, currentSampleRate);
+
+    for (int start = 0; start < buffer.getNumSamples(); start += maxChunkSize)
+        processChunk(buffer, start, juce::jmin(maxChunkSize, buffer.getNumSamples() - start));
+
+    WAVEFOLD_REVERB_PROFILE_END(profiler, buffer.getNumSamples());
+}
+
+template <typename SampleType>
+void BasicWavefoldReverbEngine<SampleType>::processChunk(juce::AudioBuffer<SampleType>& buffer, int startSample, int numSamples)
+{
+    const int numChannels = buffer.getNumChannels();
+
+    // Asleep: skip pre-delay, fold and reverb until the input rises above the gate
+    const SampleType inputPeak = buffer.getMagnitude(startSample, numSamples);
+
+    if (sleeping)
+    {
+        if (inputPeak <= noiseGateThreshold)
+        {
+            buffer.clear(startSample, numSamples);
+            WAVEFOLD_REVERB_PROFILE_STAGE(profiler, gateStage);
+            return;
+        }
+
+        sleeping = false;
+    }
+
+    WAVEFOLD_REVERB_PROFILE_STAGE(profiler, gateStage);
+
+    jassert(numChannels <= wetBuffer.getNumChannels());
+
+    // The wet path runs on the one scratch buffer; the host buffer keeps the dry signal
+    for (int channel = 0; channel < numChannels; ++channel)
+        wetBuffer.copyFrom(channel, 0, buffer, channel, startSample, numSamples);
+
+    auto wetBlock = juce::dsp::AudioBlock<SampleType>(wetBuffer).getSubsetChannelBlock(0, (size_t) numChannels)
+                                                                 .getSubBlock(0, (size_t) numSamples);
+
+    // Keep the dry signal aligned with the oversampled fold, in place
+    if (activeOversampling > 0)
+    {
+        auto dryBlock = juce::dsp::AudioBlock<SampleType>(buffer).getSubBlock((size_t) startSample, (size_t) numSamples);
+        dryDelay.process(juce::dsp::ProcessContextReplacing<SampleType>(dryBlock));
+    }
+
+    WAVEFOLD_REVERB_PROFILE_STAGE(profiler, preDelayStage);
+
+    // Frozen: the convolution takes the input, and the live path only rings out what it
+    // already had, until it has nothing left and stops
+    if (frozenReverb.wantsCapture())
+    {
+        captureParameters = params;
+
+        // Parameters is plain floats and ints, so the normalised copy's bytes name the
+        // response: a mix or fundamental change alone doesn't miss the cache
+        const auto normalised = getCaptureParameters(captureParameters);
+        frozenReverb.requestCapture(ImpulseResponseCache::hash(&normalised, sizeof(normalised)));
+    }
+
+    frozenReverb.process(wetBlock);
+    WAVEFOLD_REVERB_PROFILE_STAGE(profiler, convolutionStage);
+
+    if (! frozenReverb.isLiveFed())
+        wetBlock.clear();
+
+    if (frozenReverb.isLiveRunning())
+        processWetPath(wetBlock);
+
+    frozenReverb.addOutput(wetBlock);
+    WAVEFOLD_REVERB_PROFILE_STAGE(profiler, convolutionStage);
+
+    // Equal-power dry/wet crossfade, written straight over the dry signal. Both ends are
+    // exact: sin(0) is 0 and sin(pi / 2) rounds to 1.
+    const auto halfPi = juce::MathConstants<SampleType>::halfPi;
+    const SampleType wet = std::sin((SampleType) params.dryWet * halfPi);
+    const SampleType dry = std::sin((1 - (SampleType) params.dryWet) * halfPi);
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        SampleType* channelData = buffer.getWritePointer(channel, startSample);
+        const SampleType* wetData = wetBuffer.getReadPointer(channel);
+
+        for (int sample = 0; sample < numSamples; ++sample)
+        {
+            channelData[sample] = channelData[sample] * dry + wetData[sample] * wet;
+        }
+    }
+
+    WAVEFOLD_REVERB_PROFILE_STAGE(profiler, mixStage);
+
+    // Fall asleep once the input has been silent for longer than the pre-delay and the
+    // latency, and the output, tail included, has stayed under the gate for the hold time
+    if (inputPeak > noiseGateThreshold)
+        silentInputSamples = 0;
+    else
+        silentInputSamples += numSamples;
+
+    if (buffer.getMagnitude(startSample, numSamples) > noiseGateThreshold)
+        silenceCounter = 0;
+    else
+        silenceCounter += numSamples;
+
+    const int inputHoldSamples = (int) std::ceil(params.preDelay * 0.001 * currentSampleRate)
+                               + getOversamplerLatency(activeOversampling) + silenceCounterThreshold;
+
+    if (! isCaptureEngine && silenceCounter > silenceCounterThreshold && silentInputSamples > inputHoldSamples)
+    {
+        // Clear the internal state too, so waking up starts without ghost outputs
+        buffer.clear(startSample, numSamples);
+        reset();
+        sleeping = true;
+    }
+
+    WAVEFOLD_REVERB_PROFILE_STAGE(profiler, gateStage);
+}
+
+template <typename SampleType>
+void BasicWavefoldReverbEngine<SampleType>::processWetPath(juce::dsp::AudioBlock<SampleType>& wetBlock)
+{
+    const int numChannels = (int) wetBlock.getNumChannels();
+
+    // Apply pre-delay
+    preDelay.process(wetBlock);
+    WAVEFOLD_REVERB_PROFILE_STAGE(profiler, preDelayStage);
+
+    // Get the wavefold position
+    const int wavefoldPos = params.wavefoldPosition;
+
+    // Apply wavefolding based on position
+    if (wavefoldPos == PRE_REVERB)
+    {
+        applyWavefolding(wetBlock);
+        WAVEFOLD_REVERB_PROFILE_STAGE(profiler, preFoldStage);
+
+        // Add DC blocking (important for pre-reverb position)
+        dcBlocker.process(wetBlock);
+        WAVEFOLD_REVERB_PROFILE_STAGE(profiler, dcBlockStage);
+    }
+
+    // Smear the reverb's input, as densely as the density tier allows
+    inputDiffuser.process(wetBlock);
+    WAVEFOLD_REVERB_PROFILE_STAGE(profiler, diffusionStage);
+
+    // Apply reverb, one instance per channel pair of this block
+    const int numPairs = juce::jmin((numChannels + 1) / 2, (int) reverbs.size());
+
+    if (wavefoldPos == IN_REVERB_LOOP)
+    {
+        // Fold every delay line on each pass through the network's feedback path; the
+        // per-line fold has no ADAA history and runs at the host rate
+        for (int pair = 0; pair < numPairs; ++pair)
+            feedbackNetworks[(size_t) pair]->process(getChannelPair(wetBlock, pair), &wavefolder);
+
+        WAVEFOLD_REVERB_PROFILE_STAGE(profiler, reverbStage);
+
+        // Asymmetric folds leave DC circulating in the loop
+        dcBlocker.process(wetBlock);
+        WAVEFOLD_REVERB_PROFILE_STAGE(profiler, dcBlockStage);
+    }
+    else
+    {
+        for (int pair = 0; pair < numPairs; ++pair)
+        {
+            auto pairBlock = getChannelPair(wetBlock, pair);
+            reverbs[(size_t) pair]->process(juce::dsp::ProcessContextReplacing<SampleType>(pairBlock));
+        }
+
+        WAVEFOLD_REVERB_PROFILE_STAGE(profiler, reverbStage);
+    }
+
+    // Apply wavefolding post-reverb
+    if (wavefoldPos == POST_REVERB)
+    {
+        applyWavefolding(wetBlock);
+        WAVEFOLD_REVERB_PROFILE_STAGE(profiler, postFoldStage);
+
+        dcBlocker.process(wetBlock);
+        WAVEFOLD_REVERB_PROFILE_STAGE(profiler, dcBlockStage);
+    }
+
+    toneEQ.process(wetBlock);
+    WAVEFOLD_REVERB_PROFILE_STAGE(profiler, eqStage);
+}
+
+template class BasicWavefoldReverbEngine<float>;
+template class BasicWavefoldReverbEngine<double>;
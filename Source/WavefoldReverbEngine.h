@@ -0,0 +1,248 @@
+#pragma once
+
+#include <juce_dsp/juce_dsp.h>
+#include "Wavefolder.h" // Include our custom wavefolder
+#include "FeedbackDelayNetwork.h"
+#include "CombBankReverb.h"
+#include "PreDelay.h"
+#include "DCBlocker.h"
+#include "InputDiffuser.h"
+#include "ThreeBandEQ.h"
+#include "FrozenReverb.h"
+#include "StageProfiler.h"
+
+// GUI-free signal chain: pre-delay -> wavefolder -> input diffusion -> reverb ->
+// three-band EQ -> equal-power dry/wet mix -> noise gate.
+// In the IN_REVERB_LOOP position the reverb is a feedback delay network with the
+// wavefolder inside its feedback path instead.
+// Any channel count works: every stage except the reverb is per channel, and the reverb
+// runs one stereo instance per adjacent channel pair (L/R, C/LFE, Ls/Rs, ...), plus a
+// mono one for an odd last channel.
+// In the frozen reverb mode the wet path is captured as an impulse response and a
+// convolution stands in for it (see FrozenReverb), except in the IN_REVERB_LOOP position.
+// The plugin processor owns one of these, but it only depends on juce_core,
+// juce_audio_basics and juce_dsp so offline tools can link it without a plugin host.
+//
+// Everything that doesn't depend on the sample type lives in this base, so both
+// precisions share the same Parameters and position values
+class WavefoldReverbEngineBase
+{
+public:
+    enum WavefoldPosition {
+        PRE_REVERB,
+        IN_REVERB_LOOP,
+        POST_REVERB
+    };
+
+    // Plain copy of the plugin parameters, in the same units as the APVTS layout
+    struct Parameters
+    {
+        // Reverb parameters
+        float size = 0.5f;
+        float decay = 2.0f;
+        float diffusion = 0.5f;
+        float density = 0.5f; // input diffusion tier, trading smearing against CPU
+        float lowEQ = 0.5f;  // wet band gains: 0.5 is flat, 0 and 1 are -/+ maxEQDecibels
+        float midEQ = 0.5f;
+        float highEQ = 0.5f;
+
+        // Wavefolder parameters
+        float drive = 1.0f;
+        float threshold = 0.5f;
+        float offset = 0.0f;
+        float fundamental = 1000.0f;
+        float foldSymmetry = 0.5f;
+        float waveformShape = 0.5f;
+
+        // Additional parameters
+        float dryWet = 0.5f;
+        float preDelay = 0.0f; // milliseconds
+        int wavefoldPosition = POST_REVERB;
+        int oversampling = 0; // 0 = off, 1 = 2x, 2 = 4x, 3 = 8x
+        int antialiasing = 0; // 0 = off, 1 = first-order ADAA, 2 = second-order ADAA
+        int fdnLines = 0; // in-loop reverb: 0 = 8 delay lines, 1 = 16 delay lines
+        int foldMode = 0; // 0 = direct, 1 = baked lookup table
+        int reverbMode = 0; // 0 = live, 1 = frozen into a convolution
+    };
+
+    // One bit per Parameters field, in declaration order, so callers that already know
+    // what moved (e.g. from parameter listeners) can say so
+    using ParameterMask = juce::uint32;
+
+    enum ParameterFlags : ParameterMask
+    {
+        sizeFlag             = 1u << 0,
+        decayFlag            = 1u << 1,
+        diffusionFlag        = 1u << 2,
+        densityFlag          = 1u << 3,
+        lowEQFlag            = 1u << 4,
+        midEQFlag            = 1u << 5,
+        highEQFlag           = 1u << 6,
+        driveFlag            = 1u << 7,
+        thresholdFlag        = 1u << 8,
+        offsetFlag           = 1u << 9,
+        fundamentalFlag      = 1u << 10,
+        foldSymmetryFlag     = 1u << 11,
+        waveformShapeFlag    = 1u << 12,
+        dryWetFlag           = 1u << 13,
+        preDelayFlag         = 1u << 14,
+        wavefoldPositionFlag = 1u << 15,
+        oversamplingFlag     = 1u << 16,
+        antialiasingFlag     = 1u << 17,
+        fdnLinesFlag         = 1u << 18,
+        foldModeFlag         = 1u << 19,
+        reverbModeFlag       = 1u << 20,
+
+        allParameters        = (1u << 21) - 1
+    };
+
+    // Bits of every field that differs between the two snapshots
+    static ParameterMask getChangedParameters(const Parameters& oldParameters, const Parameters& newParameters);
+
+    // Sets the field for this plugin parameter ID from its plain value (the index for
+    // choice parameters), e.g. when reading a saved plugin state offline. Returns false
+    // if the ID isn't one of the engine's.
+    static bool setParameter(Parameters& parameters, const juce::String& parameterID, float value);
+
+    // Highest oversampling choice, as a power of two
+    static constexpr int maxOversamplingOrder = 3;
+
+    // Cut or boost at either end of the EQ parameters' range
+    static constexpr float maxEQDecibels = 12.0f;
+};
+
+// The chain itself, templated on the sample type so a double-precision host runs every
+// stage (pre-delay, fold, reverb, mix) natively instead of converting around a float
+// instance. Both instantiations are compiled into WavefoldReverbEngine.cpp.
+template <typename SampleType>
+class BasicWavefoldReverbEngine : public WavefoldReverbEngineBase
+{
+public:
+    BasicWavefoldReverbEngine();
+    ~BasicWavefoldReverbEngine() = default;
+
+    void prepare(const juce::dsp::ProcessSpec& spec);
+    void reset();
+
+    // Allocates the fold's lookup table, which prepare() only does when the fold mode is
+    // already lookup. Call it off the audio thread when the mode is switched live; until
+    // then lookup mode folds directly.
+    void prepareLookupTable() { wavefolder.prepareLookupTable(); }
+
+    // Called once per block before process(). Only the coefficients fed by changed
+    // parameters are recomputed: the first form compares against the current snapshot
+    // to find them, the second trusts the caller's mask.
+    void setParameters(const Parameters& newParameters);
+    void setParameters(const Parameters& newParameters, ParameterMask changedParameters);
+    const Parameters& getParameters() const noexcept { return params; }
+
+    // Any block length works; blocks longer than prepare()'s maximumBlockSize are split
+    void process(juce::AudioBuffer<SampleType>& buffer);
+
+    // Latency added by the wavefolder's oversampling filters (the dry path is delayed to
+    // match), in samples at the host rate. Only valid after prepare().
+    int getLatencyInSamples(const Parameters& parameters) const;
+    int getLatencyInSamples() const { return getLatencyInSamples(params); }
+
+    // The oversampling choice that actually runs: the in-loop fold is never oversampled,
+    // so it's 0 in that position whatever the parameter says
+    static int getOversamplingChoice(const Parameters& parameters) noexcept;
+
+    // How long the output keeps going after the input stops: pre-delay, oversampling
+    // latency and the reverb tail down to the noise gate level. Only valid after prepare().
+    double getTailLengthSeconds(const Parameters& parameters) const;
+    double getTailLengthSeconds() const { return getTailLengthSeconds(params); }
+
+    // True while the chain is asleep (see process())
+    bool isSleeping() const noexcept { return sleeping; }
+
+    // True while the frozen reverb's convolution stands in for the wet path, from when the
+    // capture after switching to the frozen mode has landed. Audio thread only.
+    bool isFrozen() const noexcept { return frozenReverb.isActive(); }
+
+   #if WAVEFOLD_REVERB_STAGE_PROFILING
+    // Every process() call records its per-stage timings here; nullptr stops recording
+    void setStageProfiler(StageProfiler* newProfiler) noexcept { profiler = newProfiler; }
+   #endif
+
+private:
+    Parameters params;
+
+    // noise gate to cut signals below threshold - avoids signal bleed
+    float noiseGateThreshold = 0.0001f; // Adjust this value as needed
+    int silenceCounter = 0;
+    int silenceCounterThreshold = 1000; // Approx. 20ms at 48kHz
+
+    // Sleep state: once the input has been silent for longer than the pre-delay and the
+    // output has stayed under the gate, the chain is reset and skipped until the input
+    // rises again
+    bool sleeping = false;
+    int silentInputSamples = 0;
+
+    // Set on the private engines that render the frozen reverb's responses: they never
+    // sleep, since the gate would cut the quiet impulse's tail, and never freeze
+    bool isCaptureEngine = false;
+
+    // The settings the frozen reverb's next response is rendered at, saved by the audio
+    // thread before it requests a capture
+    Parameters captureParameters;
+
+    // The settings with everything that doesn't shape the response set to one value:
+    // fully wet, live, and the default fundamental (which only runs the fold's unused
+    // phase), so settings that render the same response share a cache key
+    static Parameters getCaptureParameters(const Parameters& parameters) noexcept;
+
+    // DSP Components
+    PreDelay<SampleType> preDelay;
+    InputDiffuser<SampleType> inputDiffuser;
+    juce::Reverb::Parameters reverbParams;
+    std::vector<std::unique_ptr<CombBankReverb<SampleType>>> reverbs;
+    std::vector<std::unique_ptr<FeedbackDelayNetwork<SampleType>>> feedbackNetworks;
+    Wavefolder<SampleType> wavefolder;
+
+    // Only the fold stage is oversampled; one polyphase half-band chain per choice so
+    // switching doesn't allocate on the audio thread
+    std::array<std::unique_ptr<juce::dsp::Oversampling<SampleType>>, maxOversamplingOrder> oversamplers;
+    juce::dsp::DelayLine<SampleType, juce::dsp::DelayLineInterpolationTypes::None> dryDelay;
+    int activeOversampling = 0;
+
+    // Only one of the fold positions runs it in any block, so they share it
+    DCBlocker<SampleType> dcBlocker;
+
+    // Tone control on the whole wet signal, whatever the fold position
+    ThreeBandEQ<SampleType> toneEQ;
+
+    // Scratch buffer for the wet path; the dry signal stays in the host buffer, and
+    // the mix is written back over it
+    juce::AudioBuffer<SampleType> wetBuffer;
+    double currentSampleRate = 44100.0;
+
+   #if WAVEFOLD_REVERB_STAGE_PROFILING
+    StageProfiler* profiler = nullptr;
+   #endif
+
+    // Declared last so it's destroyed first: its destructor waits for a capture in
+    // progress, which reads captureParameters
+    FrozenReverb<SampleType> frozenReverb;
+
+    // Internal methods
+    void processChunk(juce::AudioBuffer<SampleType>& buffer, int startSample, int numSamples);
+    void processWetPath(juce::dsp::AudioBlock<SampleType>& wetBlock);
+    void applyWavefolding(juce::dsp::AudioBlock<SampleType>& block);
+    static juce::dsp::AudioBlock<SampleType> getChannelPair(const juce::dsp::AudioBlock<SampleType>& block, int pair);
+    void applyParameters(ParameterMask changedParameters);
+    void updateReverbParameters();
+    void updateOversampling();
+    int getOversamplerLatency(int oversamplingChoice) const;
+    void updateEQ();
+    void updateFrozenReverb(ParameterMask changedParameters);
+    void renderImpulseResponses(typename FrozenReverb<SampleType>::ImpulseResponses& responses, double sampleRate, bool withMono) const;
+
+    // Either precision renders the frozen reverb's responses on a double engine
+    template <typename> friend class BasicWavefoldReverbEngine;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(BasicWavefoldReverbEngine)
+};
+
+using WavefoldReverbEngine = BasicWavefoldReverbEngine<float>;
+using WavefoldReverbEngineDouble = BasicWavefoldReverbEngine<double>;
@@ -0,0 +1,1128 @@
+// Offline benchmark for WavefoldReverbEngine.
+//
+// Sweeps wavefold position, waveform shape region, drive/threshold extremes, channel
+// count and host block size (and the delay line count of the in-loop network), and
+// prints one JSON document with ns/sample, real-time factor and block-time percentiles
+// for every case. Run it before and after a DSP change and diff the output to spot
+// regressions.
+//
+// --fold-stress runs only the Wavefolder on its own across the full drive/threshold/offset
+// range and reports the spread of its per-sample cost, which should stay flat now that no
+// fold shape iterates on the input. It also times the first- and second-order ADAA block
+// paths (and their cost over the plain block path) and the baked lookup table next to
+// the plain one, and checks the vectorised block path against process() for every
+// shape, symmetry and drive, and the ADAA antiderivatives against their fold curves by
+// finite differences: the tool exits with status 2 if either strays further than
+// simdErrorBound or antiderivativeErrorBound.
+//
+// --precision compares the float engine with the double one on double input, against the
+// double -> float -> double round trip a host makes around a float-only plugin, so the
+// conversion cost the native double path removes shows up next to its own cost.
+//
+// --footprint reports each engine's heap use after prepare() (measured from the C
+// library's allocator statistics where available, -1 elsewhere) and its ns/sample for
+// a plain post-reverb setting, per channel count and block size.
+//
+// --density reports the cost of each input diffusion tier, for the diffuser alone and
+// for the whole engine at that density, per channel count.
+//
+// --frozen compares the live wet path with the frozen reverb's convolution once it has
+// taken over, per fold position and tail length: the cost of each, how long the capture
+// took, and how far the frozen output strays from the live one at a quiet and a
+// programme input level.
+//
+// --instances creates 200 frozen engines at the same settings, one after another, and
+// reports for a few of them how long they took to take over and how much heap they
+// added, from construction until then. Only the first renders the capture; the others
+// share its partitioned response through the impulse response cache.
+//
+// Usage: WavefoldReverbBenchmark [--seconds <audio seconds per case>] [--sample-rate <Hz>]
+//                                [--fold-stress | --precision | --footprint | --density | --frozen | --instances]
+//                                [--output <file.json>]
+
+#include <juce_core/juce_core.h>
+#include "WavefoldReverbEngine.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iterator>
+#include <iostream>
+#include <limits>
+#include <thread>
+#include <utility>
+
+#if defined (__linux__)
+ #include <malloc.h>
+#endif
+
+namespace
+{
+    struct BenchmarkSettings
+    {
+        double secondsPerCase = 1.0;
+        double sampleRate = 48000.0;
+        bool foldStress = false;
+        bool precision = false;
+        bool footprint = false;
+        bool density = false;
+        bool frozen = false;
+        bool instances = false;
+        juce::File outputFile;
+    };
+
+    struct FoldSetting
+    {
+        const char* name;
+        float drive;
+        float threshold;
+    };
+
+    struct ShapeSetting
+    {
+        const char* name;
+        float waveformShape;
+    };
+
+    const char* positionNames[] = { "PRE_REVERB", "IN_REVERB_LOOP", "POST_REVERB" };
+
+    // One point inside each of the three regions foldSignal() switches between
+    const ShapeSetting shapes[] = {
+        { "triangle", 0.15f },
+        { "sine", 0.5f },
+        { "tanh", 0.85f }
+    };
+
+    const FoldSetting foldSettings[] = {
+        { "gentle", 1.0f, 1.0f },
+        { "hot_drive", 10.0f, 1.0f },
+        { "low_threshold", 1.0f, 0.1f },
+        { "extreme", 10.0f, 0.1f }
+    };
+
+    // Mono, stereo, 5.1 and 7.1.4
+    const int channelCounts[] = { 1, 2, 6, 12 };
+    const int blockSizes[] = { 16, 32, 64, 128, 256, 512, 1024, 2048, 4096 };
+
+    // How a double-precision host gets audio through the engine
+    enum class PrecisionPath
+    {
+        floatNative,        // float host, float engine
+        doubleNative,       // double host, double engine
+        doubleThroughFloat  // double host, converting around the float engine
+    };
+
+    // Deterministic programme-like input: a tone plus noise at roughly -6 dBFS
+    void fillInput(juce::AudioBuffer<float>& buffer, double sampleRate)
+    {
+        juce::Random random(0x5eed);
+        const double phaseIncrement = juce::MathConstants<double>::twoPi * 220.0 / sampleRate;
+
+        for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+        {
+            float* data = buffer.getWritePointer(channel);
+
+            for (int sample = 0; sample < buffer.getNumSamples(); ++sample)
+            {
+                const float tone = (float) std::sin(phaseIncrement * sample);
+                const float noise = random.nextFloat() * 2.0f - 1.0f;
+                data[sample] = 0.35f * tone + 0.15f * noise;
+            }
+        }
+    }
+
+    double percentile(std::vector<double> values, double fraction)
+    {
+        if (values.empty())
+            return 0.0;
+
+        std::sort(values.begin(), values.end());
+        const auto index = (size_t) juce::jlimit(0.0, (double) values.size() - 1.0,
+                                                 std::ceil(fraction * (double) values.size()) - 1.0);
+        return values[index];
+    }
+
+    juce::var runCase(const BenchmarkSettings& settings, const juce::AudioBuffer<float>& input,
+                      int position, const ShapeSetting& shape, const FoldSetting& fold,
+                      int numChannels, int blockSize, int fdnLines)
+    {
+        WavefoldReverbEngine engine;
+
+        WavefoldReverbEngine::Parameters params;
+        params.wavefoldPosition = position;
+        params.waveformShape = shape.waveformShape;
+        params.drive = fold.drive;
+        params.threshold = fold.threshold;
+        params.preDelay = 20.0f;
+        params.fdnLines = fdnLines;
+
+        engine.setParameters(params);
+        engine.prepare({ settings.sampleRate, (juce::uint32) blockSize, (juce::uint32) numChannels });
+
+        juce::AudioBuffer<float> block(numChannels, blockSize);
+        const int totalSamples = input.getNumSamples() - input.getNumSamples() % blockSize;
+        const int numBlocks = totalSamples / blockSize;
+
+        std::vector<double> blockNanos;
+        blockNanos.reserve((size_t) numBlocks);
+
+        juce::ScopedNoDenormals noDenormals;
+
+        // One pass to warm caches and let the reverb fill up, then the timed pass
+        for (int pass = 0; pass < 2; ++pass)
+        {
+            for (int b = 0; b < numBlocks; ++b)
+            {
+                for (int channel = 0; channel < numChannels; ++channel)
+                    block.copyFrom(channel, 0, input, channel, b * blockSize, blockSize);
+
+                const auto start = std::chrono::steady_clock::now();
+                engine.setParameters(params);
+                engine.process(block);
+                const auto end = std::chrono::steady_clock::now();
+
+                if (pass == 1)
+                    blockNanos.push_back((double) std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+            }
+        }
+
+        double totalNanos = 0.0;
+        for (auto t : blockNanos)
+            totalNanos += t;
+
+        const double processedSamples = (double) numBlocks * blockSize;
+        const double audioNanos = processedSamples / settings.sampleRate * 1.0e9;
+
+        auto* result = new juce::DynamicObject();
+        result->setProperty("wavefoldPosition", positionNames[position]);
+        result->setProperty("waveformShape", shape.name);
+        result->setProperty("fold", fold.name);
+        result->setProperty("fdnLines", fdnLines == 1 ? 16 : 8);
+        result->setProperty("drive", fold.drive);
+        result->setProperty("threshold", fold.threshold);
+        result->setProperty("channels", numChannels);
+        result->setProperty("blockSize", blockSize);
+        result->setProperty("nsPerSample", totalNanos / (processedSamples * numChannels));
+        result->setProperty("realTimeFactor", totalNanos > 0.0 ? audioNanos / totalNanos : 0.0);
+        result->setProperty("blockUsP50", percentile(blockNanos, 0.50) * 1.0e-3);
+        result->setProperty("blockUsP90", percentile(blockNanos, 0.90) * 1.0e-3);
+        result->setProperty("blockUsP99", percentile(blockNanos, 0.99) * 1.0e-3);
+        result->setProperty("blockUsMax", percentile(blockNanos, 1.0) * 1.0e-3);
+        result->setProperty("blockBudgetUs", blockSize / settings.sampleRate * 1.0e6);
+        return juce::var(result);
+    }
+
+    // Waits for the wavefolder's baked table to match these settings, then times one block
+    double timeLookupTable(Wavefolder<float>& wavefolder, const juce::AudioBuffer<float>& input, juce::AudioBuffer<float>& block,
+                           float drive, float threshold, float offset, float shape)
+    {
+        const auto bakeDeadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+        juce::AudioBuffer<float> probe(1, 1);
+
+        while (! wavefolder.isLookupTableReady(threshold, offset, 0.5f, shape)
+               && std::chrono::steady_clock::now() < bakeDeadline)
+        {
+            wavefolder.processBlock(probe, drive, threshold, offset, 0.5f, shape, 1000.0f);
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        block.copyFrom(0, 0, input, 0, 0, input.getNumSamples());
+        const auto start = std::chrono::steady_clock::now();
+        wavefolder.processBlock(block, drive, threshold, offset, 0.5f, shape, 1000.0f);
+        return (double) std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // Wavefolder.h's bound on the block path's difference from process(), before the
+    // output's 1/drive scaling
+    constexpr double simdErrorBound = 1.0e-4;
+
+    // Largest difference between process() and the block path, scaled back to before
+    // the 0.95 / drive output gain so it compares with simdErrorBound
+    double measureSimdError(const BenchmarkSettings& settings, const juce::AudioBuffer<float>& hotInput, juce::AudioBuffer<float>& block,
+                            float drive, float threshold, float offset, float symmetry, float shape)
+    {
+        const int numSamples = hotInput.getNumSamples();
+        const juce::dsp::ProcessSpec spec { settings.sampleRate, (juce::uint32) numSamples, 1 };
+
+        Wavefolder<float> scalar, vectorised;
+        scalar.prepare(spec);
+        vectorised.prepare(spec);
+
+        block.copyFrom(0, 0, hotInput, 0, 0, numSamples);
+        vectorised.processBlock(block, drive, threshold, offset, symmetry, shape, 1000.0f);
+
+        const float* in = hotInput.getReadPointer(0);
+        const float* out = block.getReadPointer(0);
+        double maxError = 0.0;
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const float expected = scalar.process(in[i], drive, threshold, offset, symmetry, shape, 1000.0f);
+
+            // Where the output sits on the silence limiter's 1e-5 edge, one path can take
+            // it and the other not. Measure the other one's distance from that edge then,
+            // not from the limiter's input * 0.01 fallback.
+            const float limited = in[i] * 0.01f;
+            const bool scalarLimited = expected == limited && std::abs(in[i]) > 0.001f;
+            const bool blockLimited = out[i] == limited && std::abs(in[i]) > 0.001f;
+
+            if (scalarLimited != blockLimited)
+            {
+                const float unlimited = scalarLimited ? out[i] : expected;
+                maxError = juce::jmax(maxError, juce::jmax(0.0, std::abs((double) unlimited) - 0.00001));
+                continue;
+            }
+
+            maxError = juce::jmax(maxError, std::abs((double) expected - (double) out[i]));
+        }
+
+        return maxError * drive / 0.95;
+    }
+
+    // How far a central difference of each antiderivative may fall outside the range of
+    // the function it integrates across the difference's stencil
+    constexpr double antiderivativeErrorBound = 1.0e-6;
+
+    // Checks FoldAntiderivatives against its own fold() by finite differences: first()
+    // must differentiate to fold() and second() to first(). Comparing with the range of
+    // the integrand over [x - h, x + h] rather than its centre value keeps the check
+    // meaningful across the folds' corners and jumps. The grid spans the fold input the
+    // stress sweep reaches (hot input times the largest drive, plus the largest offset).
+    double measureAntiderivativeError(float threshold, float symmetry, float shape)
+    {
+        constexpr double range = 21.0;
+        constexpr double h = 1.0e-5;
+        constexpr int numPoints = 8192;
+
+        FoldAntiderivatives antiderivatives;
+        antiderivatives.update(threshold, symmetry * 2.0f - 1.0f, shape);
+
+        const auto distanceOutside = [] (double value, double a, double b, double c)
+        {
+            const double lowest = std::min({ a, b, c });
+            const double highest = std::max({ a, b, c });
+            return value < lowest ? lowest - value : (value > highest ? value - highest : 0.0);
+        };
+
+        double maxError = 0.0;
+
+        for (int i = 0; i <= numPoints; ++i)
+        {
+            const double x = range * (2.0 * i / numPoints - 1.0);
+
+            const double firstSlope = (antiderivatives.first(x + h) - antiderivatives.first(x - h)) / (2.0 * h);
+            maxError = juce::jmax(maxError, distanceOutside(firstSlope, antiderivatives.fold(x - h),
+                                                            antiderivatives.fold(x), antiderivatives.fold(x + h)));
+
+            const double secondSlope = (antiderivatives.second(x + h) - antiderivatives.second(x - h)) / (2.0 * h);
+            maxError = juce::jmax(maxError, distanceOutside(secondSlope, antiderivatives.first(x - h),
+                                                            antiderivatives.first(x), antiderivatives.first(x + h)));
+        }
+
+        return maxError;
+    }
+
+    // Times the scalar Wavefolder::process() and the block path on full-scale input, and
+    // measures how far apart they are
+    juce::var runFoldStress(const BenchmarkSettings& settings, const juce::AudioBuffer<float>& input)
+    {
+        const float drives[] = { 1.0f, 2.5f, 5.0f, 10.0f };
+        const float thresholds[] = { 0.1f, 0.25f, 0.5f, 1.0f };
+        const float offsets[] = { -1.0f, 0.0f, 1.0f };
+
+        // Negative, none and positive symmetry modes, at the ends and in between
+        const float symmetries[] = { 0.0f, 0.25f, 0.5f, 0.75f, 1.0f };
+
+        const int numSamples = input.getNumSamples();
+        juce::AudioBuffer<float> hotInput(1, numSamples);
+        hotInput.copyFrom(0, 0, input.getReadPointer(0), numSamples, 2.0f);
+
+        juce::AudioBuffer<float> block(1, numSamples);
+        juce::Array<juce::var> cases;
+        juce::Array<juce::var> summaries;
+
+        juce::ScopedNoDenormals noDenormals;
+        double worstSimdError = 0.0;
+        double worstAntiderivativeError = 0.0;
+
+        for (const auto& shape : shapes)
+        {
+            double cheapest = std::numeric_limits<double>::max();
+            double dearest = 0.0;
+            double shapeSimdError = 0.0;
+            double shapeAntiderivativeError = 0.0;
+            double dearestAdaaOverBlock[2] = {};
+
+            // The antiderivatives depend only on threshold, symmetry and shape
+            for (auto threshold : thresholds)
+                for (auto symmetry : symmetries)
+                    shapeAntiderivativeError = juce::jmax(shapeAntiderivativeError,
+                                                          measureAntiderivativeError(threshold, symmetry, shape.waveformShape));
+
+            for (auto drive : drives)
+            {
+                for (auto threshold : thresholds)
+                {
+                    for (auto offset : offsets)
+                    {
+                        Wavefolder<float> wavefolder;
+                        wavefolder.prepare({ settings.sampleRate, (juce::uint32) numSamples, 1 });
+
+                        const float* in = hotInput.getReadPointer(0);
+                        float* out = block.getWritePointer(0);
+
+                        auto start = std::chrono::steady_clock::now();
+
+                        for (int i = 0; i < numSamples; ++i)
+                            out[i] = wavefolder.process(in[i], drive, threshold, offset, 0.5f, shape.waveformShape, 1000.0f);
+
+                        const auto scalarNanos = (double) std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+                        block.copyFrom(0, 0, hotInput, 0, 0, numSamples);
+                        start = std::chrono::steady_clock::now();
+                        wavefolder.processBlock(block, drive, threshold, offset, 0.5f, shape.waveformShape, 1000.0f);
+                        const auto blockNanos = (double) std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+                        double antialiasedNanos[2] = {};
+
+                        for (int order = 1; order <= 2; ++order)
+                        {
+                            wavefolder.setAntialiasingOrder(order);
+                            block.copyFrom(0, 0, hotInput, 0, 0, numSamples);
+                            start = std::chrono::steady_clock::now();
+                            wavefolder.processBlock(block, drive, threshold, offset, 0.5f, shape.waveformShape, 1000.0f);
+                            antialiasedNanos[order - 1] = (double) std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+                        }
+
+                        wavefolder.setAntialiasingOrder(0);
+                        wavefolder.prepareLookupTable();
+                        wavefolder.setLookupTableEnabled(true);
+                        const double lookupNanos = timeLookupTable(wavefolder, hotInput, block, drive, threshold, offset, shape.waveformShape);
+                        wavefolder.setLookupTableEnabled(false);
+
+                        const double scalarPerSample = scalarNanos / numSamples;
+                        cheapest = juce::jmin(cheapest, scalarPerSample);
+                        dearest = juce::jmax(dearest, scalarPerSample);
+
+                        double simdError = 0.0;
+
+                        for (auto symmetry : symmetries)
+                            simdError = juce::jmax(simdError, measureSimdError(settings, hotInput, block, drive, threshold,
+                                                                               offset, symmetry, shape.waveformShape));
+
+                        shapeSimdError = juce::jmax(shapeSimdError, simdError);
+
+                        const double adaa1OverBlock = blockNanos > 0.0 ? antialiasedNanos[0] / blockNanos : 0.0;
+                        const double adaa2OverBlock = blockNanos > 0.0 ? antialiasedNanos[1] / blockNanos : 0.0;
+                        dearestAdaaOverBlock[0] = juce::jmax(dearestAdaaOverBlock[0], adaa1OverBlock);
+                        dearestAdaaOverBlock[1] = juce::jmax(dearestAdaaOverBlock[1], adaa2OverBlock);
+
+                        auto* result = new juce::DynamicObject();
+                        result->setProperty("waveformShape", shape.name);
+                        result->setProperty("drive", drive);
+                        result->setProperty("threshold", threshold);
+                        result->setProperty("offset", offset);
+                        result->setProperty("scalarNsPerSample", scalarPerSample);
+                        result->setProperty("blockNsPerSample", blockNanos / numSamples);
+                        result->setProperty("adaa1NsPerSample", antialiasedNanos[0] / numSamples);
+                        result->setProperty("adaa2NsPerSample", antialiasedNanos[1] / numSamples);
+                        result->setProperty("adaa1OverBlock", adaa1OverBlock);
+                        result->setProperty("adaa2OverBlock", adaa2OverBlock);
+                        result->setProperty("lookupNsPerSample", lookupNanos / numSamples);
+                        result->setProperty("simdMaxAbsError", simdError);
+                        cases.add(juce::var(result));
+                    }
+                }
+            }
+
+            auto* summary = new juce::DynamicObject();
+            summary->setProperty("waveformShape", shape.name);
+            summary->setProperty("minNsPerSample", cheapest);
+            summary->setProperty("maxNsPerSample", dearest);
+            summary->setProperty("maxOverMin", cheapest > 0.0 ? dearest / cheapest : 0.0);
+            summary->setProperty("maxAdaa1OverBlock", dearestAdaaOverBlock[0]);
+            summary->setProperty("maxAdaa2OverBlock", dearestAdaaOverBlock[1]);
+            summary->setProperty("simdMaxAbsError", shapeSimdError);
+            summary->setProperty("antiderivativeMaxError", shapeAntiderivativeError);
+            summaries.add(juce::var(summary));
+
+            worstSimdError = juce::jmax(worstSimdError, shapeSimdError);
+            worstAntiderivativeError = juce::jmax(worstAntiderivativeError, shapeAntiderivativeError);
+        }
+
+        auto* report = new juce::DynamicObject();
+        report->setProperty("sampleRate", settings.sampleRate);
+        report->setProperty("samplesPerCase", numSamples);
+        report->setProperty("simdErrorBound", simdErrorBound);
+        report->setProperty("simdMaxAbsError", worstSimdError);
+        report->setProperty("simdWithinBound", worstSimdError <= simdErrorBound);
+        report->setProperty("antiderivativeErrorBound", antiderivativeErrorBound);
+        report->setProperty("antiderivativeMaxError", worstAntiderivativeError);
+        report->setProperty("antiderivativesWithinBound", worstAntiderivativeError <= antiderivativeErrorBound);
+        report->setProperty("summary", summaries);
+        report->setProperty("cases", cases);
+        return juce::var(report);
+    }
+
+    // Renders the input twice along one path (warm-up, then timed) and returns the time
+    // spent inside the timed pass, conversions included. The timed pass's output is left
+    // in rendered.
+    double renderPrecisionPath(const BenchmarkSettings& settings, const juce::AudioBuffer<float>& input,
+                               const juce::AudioBuffer<double>& doubleInput, const WavefoldReverbEngine::Parameters& params,
+                               int numChannels, int blockSize, PrecisionPath path, juce::AudioBuffer<double>& rendered)
+    {
+        const juce::dsp::ProcessSpec spec { settings.sampleRate, (juce::uint32) blockSize, (juce::uint32) numChannels };
+        WavefoldReverbEngine floatEngine;
+        WavefoldReverbEngineDouble doubleEngine;
+
+        if (path == PrecisionPath::doubleNative)
+        {
+            doubleEngine.setParameters(params);
+            doubleEngine.prepare(spec);
+        }
+        else
+        {
+            floatEngine.setParameters(params);
+            floatEngine.prepare(spec);
+        }
+
+        const int numBlocks = input.getNumSamples() / blockSize;
+        juce::AudioBuffer<float> floatBlock(numChannels, blockSize);
+        juce::AudioBuffer<double> doubleBlock(numChannels, blockSize);
+        rendered.setSize(numChannels, numBlocks * blockSize);
+
+        juce::ScopedNoDenormals noDenormals;
+        double totalNanos = 0.0;
+
+        for (int pass = 0; pass < 2; ++pass)
+        {
+            for (int b = 0; b < numBlocks; ++b)
+            {
+                const int start = b * blockSize;
+
+                for (int channel = 0; channel < numChannels; ++channel)
+                {
+                    if (path == PrecisionPath::floatNative)
+                        floatBlock.copyFrom(channel, 0, input, channel, start, blockSize);
+                    else
+                        doubleBlock.copyFrom(channel, 0, doubleInput, channel, start, blockSize);
+                }
+
+                const auto blockStart = std::chrono::steady_clock::now();
+
+                if (path == PrecisionPath::floatNative)
+                {
+                    floatEngine.setParameters(params);
+                    floatEngine.process(floatBlock);
+                }
+                else if (path == PrecisionPath::doubleNative)
+                {
+                    doubleEngine.setParameters(params);
+                    doubleEngine.process(doubleBlock);
+                }
+                else
+                {
+                    // The copies a host wrapper makes around a float-only processBlock()
+                    floatBlock.makeCopyOf(doubleBlock, true);
+                    floatEngine.setParameters(params);
+                    floatEngine.process(floatBlock);
+                    doubleBlock.makeCopyOf(floatBlock, true);
+                }
+
+                const auto blockEnd = std::chrono::steady_clock::now();
+
+                if (pass == 0)
+                    continue;
+
+                totalNanos += (double) std::chrono::duration_cast<std::chrono::nanoseconds>(blockEnd - blockStart).count();
+
+                for (int channel = 0; channel < numChannels; ++channel)
+                {
+                    double* destination = rendered.getWritePointer(channel, start);
+
+                    if (path == PrecisionPath::floatNative)
+                    {
+                        const float* source = floatBlock.getReadPointer(channel);
+                        std::copy(source, source + blockSize, destination);
+                    }
+                    else
+                    {
+                        const double* source = doubleBlock.getReadPointer(channel);
+                        std::copy(source, source + blockSize, destination);
+                    }
+                }
+            }
+        }
+
+        return totalNanos;
+    }
+
+    // Float against native double against double converted around float, for every
+    // position at a few channel counts and block sizes
+    juce::var runPrecision(const BenchmarkSettings& settings, const juce::AudioBuffer<float>& input)
+    {
+        const int precisionChannelCounts[] = { 2, 12 };
+        const int precisionBlockSizes[] = { 64, 256, 1024 };
+
+        juce::AudioBuffer<double> doubleInput;
+        doubleInput.makeCopyOf(input);
+
+        juce::Array<juce::var> cases;
+
+        for (int position = 0; position < (int) std::size(positionNames); ++position)
+        {
+            for (auto numChannels : precisionChannelCounts)
+            {
+                for (auto blockSize : precisionBlockSizes)
+                {
+                    WavefoldReverbEngine::Parameters params;
+                    params.wavefoldPosition = position;
+                    params.drive = 4.0f;
+                    params.threshold = 0.4f;
+                    params.preDelay = 20.0f;
+
+                    juce::AudioBuffer<double> rendered[3];
+                    double nanos[3] = {};
+
+                    for (int path = 0; path < 3; ++path)
+                        nanos[path] = renderPrecisionPath(settings, input, doubleInput, params, numChannels, blockSize,
+                                                          (PrecisionPath) path, rendered[path]);
+
+                    // How far the double render drifts from the float one
+                    double maxDifference = 0.0;
+
+                    for (int channel = 0; channel < numChannels; ++channel)
+                    {
+                        const double* floatOutput = rendered[0].getReadPointer(channel);
+                        const double* doubleOutput = rendered[1].getReadPointer(channel);
+
+                        for (int sample = 0; sample < rendered[0].getNumSamples(); ++sample)
+                            maxDifference = juce::jmax(maxDifference, std::abs(doubleOutput[sample] - floatOutput[sample]));
+                    }
+
+                    const double processedSamples = (double) rendered[0].getNumSamples() * numChannels;
+                    const double floatNs = nanos[0] / processedSamples;
+                    const double doubleNs = nanos[1] / processedSamples;
+                    const double throughFloatNs = nanos[2] / processedSamples;
+
+                    auto* result = new juce::DynamicObject();
+                    result->setProperty("wavefoldPosition", positionNames[position]);
+                    result->setProperty("channels", numChannels);
+                    result->setProperty("blockSize", blockSize);
+                    result->setProperty("floatNsPerSample", floatNs);
+                    result->setProperty("doubleNsPerSample", doubleNs);
+                    result->setProperty("doubleThroughFloatNsPerSample", throughFloatNs);
+                    result->setProperty("conversionNsPerSample", throughFloatNs - floatNs);
+                    result->setProperty("doubleSavingNsPerSample", throughFloatNs - doubleNs);
+                    result->setProperty("doubleOverFloat", floatNs > 0.0 ? doubleNs / floatNs : 0.0);
+                    result->setProperty("maxDifferenceFromFloat", maxDifference);
+                    cases.add(juce::var(result));
+                }
+            }
+        }
+
+        auto* report = new juce::DynamicObject();
+        report->setProperty("sampleRate", settings.sampleRate);
+        report->setProperty("secondsPerCase", settings.secondsPerCase);
+        report->setProperty("cases", cases);
+        return juce::var(report);
+    }
+
+    // Bytes the allocator has handed out and not had back, or -1 if it can't say
+    juce::int64 getHeapBytesInUse()
+    {
+       #if defined (__GLIBC__) && __GLIBC_PREREQ (2, 33)
+        const auto info = mallinfo2();
+        return (juce::int64) (info.uordblks + info.hblkhd);
+       #else
+        return -1;
+       #endif
+    }
+
+    juce::var runFootprint(const BenchmarkSettings& settings, const juce::AudioBuffer<float>& input)
+    {
+        const int footprintBlockSizes[] = { 32, 512, 4096 };
+        juce::Array<juce::var> cases;
+
+        for (auto numChannels : channelCounts)
+        {
+            for (auto blockSize : footprintBlockSizes)
+            {
+                WavefoldReverbEngine::Parameters params;
+                params.preDelay = 20.0f;
+
+                const auto heapBefore = getHeapBytesInUse();
+                auto engine = std::make_unique<WavefoldReverbEngine>();
+                engine->setParameters(params);
+                engine->prepare({ settings.sampleRate, (juce::uint32) blockSize, (juce::uint32) numChannels });
+                const auto heapAfter = getHeapBytesInUse();
+
+                juce::AudioBuffer<float> block(numChannels, blockSize);
+                const int numBlocks = input.getNumSamples() / blockSize;
+                juce::ScopedNoDenormals noDenormals;
+
+                const auto start = std::chrono::steady_clock::now();
+
+                for (int b = 0; b < numBlocks; ++b)
+                {
+                    for (int channel = 0; channel < numChannels; ++channel)
+                        block.copyFrom(channel, 0, input, channel, b * blockSize, blockSize);
+
+                    engine->setParameters(params);
+                    engine->process(block);
+                }
+
+                const auto nanos = (double) std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+                auto* result = new juce::DynamicObject();
+                result->setProperty("channels", numChannels);
+                result->setProperty("blockSize", blockSize);
+                result->setProperty("heapBytes", heapBefore >= 0 && heapAfter >= 0 ? heapAfter - heapBefore : (juce::int64) -1);
+                result->setProperty("engineBytes", (int) sizeof (WavefoldReverbEngine));
+                result->setProperty("nsPerSample", nanos / ((double) numBlocks * blockSize * numChannels));
+                cases.add(juce::var(result));
+            }
+        }
+
+        auto* report = new juce::DynamicObject();
+        report->setProperty("sampleRate", settings.sampleRate);
+        report->setProperty("secondsPerCase", settings.secondsPerCase);
+        report->setProperty("cases", cases);
+        return juce::var(report);
+    }
+
+    // Renders the input through the engine in blockSize pieces and returns the time spent
+    double timeEngine(WavefoldReverbEngine& engine, const WavefoldReverbEngine::Parameters& params,
+                      const juce::AudioBuffer<float>& input, int numChannels, int blockSize)
+    {
+        juce::AudioBuffer<float> block(numChannels, blockSize);
+        const int numBlocks = input.getNumSamples() / blockSize;
+        juce::ScopedNoDenormals noDenormals;
+
+        const auto start = std::chrono::steady_clock::now();
+
+        for (int b = 0; b < numBlocks; ++b)
+        {
+            for (int channel = 0; channel < numChannels; ++channel)
+                block.copyFrom(channel, 0, input, channel, b * blockSize, blockSize);
+
+            engine.setParameters(params);
+            engine.process(block);
+        }
+
+        return (double) std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // Cost of every input diffusion tier: the diffuser on its own, and the whole engine at
+    // that density next to the lowest tier, so the extra per tier is plain
+    juce::var runDensity(const BenchmarkSettings& settings, const juce::AudioBuffer<float>& input)
+    {
+        constexpr int blockSize = 512;
+        constexpr int numTiers = InputDiffuser<float>::numTiers;
+        juce::Array<juce::var> cases;
+
+        for (auto numChannels : channelCounts)
+        {
+            const int numBlocks = input.getNumSamples() / blockSize;
+            const double processedSamples = (double) numBlocks * blockSize * numChannels;
+            double lowestTierEngineNs = 0.0;
+
+            for (int tier = 0; tier < numTiers; ++tier)
+            {
+                const float density = (float) tier / (float) (numTiers - 1);
+                const juce::dsp::ProcessSpec spec { settings.sampleRate, (juce::uint32) blockSize, (juce::uint32) numChannels };
+
+                InputDiffuser<float> diffuser;
+                diffuser.setDensity(density);
+                diffuser.prepare(spec);
+
+                juce::AudioBuffer<float> block(numChannels, blockSize);
+                juce::ScopedNoDenormals noDenormals;
+
+                auto start = std::chrono::steady_clock::now();
+
+                for (int b = 0; b < numBlocks; ++b)
+                {
+                    for (int channel = 0; channel < numChannels; ++channel)
+                        block.copyFrom(channel, 0, input, channel, b * blockSize, blockSize);
+
+                    diffuser.process(juce::dsp::AudioBlock<float>(block));
+                }
+
+                const auto diffuserNs = (double) std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count()
+                                      / processedSamples;
+
+                WavefoldReverbEngine::Parameters params;
+                params.preDelay = 20.0f;
+                params.density = density;
+
+                WavefoldReverbEngine engine;
+                engine.setParameters(params);
+                engine.prepare(spec);
+
+                // One pass to let the reverb fill up, then the timed pass
+                timeEngine(engine, params, input, numChannels, blockSize);
+                const double engineNs = timeEngine(engine, params, input, numChannels, blockSize) / processedSamples;
+
+                if (tier == 0)
+                    lowestTierEngineNs = engineNs;
+
+                auto* result = new juce::DynamicObject();
+                result->setProperty("tier", tier);
+                result->setProperty("density", density);
+                result->setProperty("stages", InputDiffuser<float>::getNumStages(tier));
+                result->setProperty("channels", numChannels);
+                result->setProperty("blockSize", blockSize);
+                result->setProperty("diffuserNsPerSample", diffuserNs);
+                result->setProperty("engineNsPerSample", engineNs);
+                result->setProperty("engineOverLowestTier", lowestTierEngineNs > 0.0 ? engineNs / lowestTierEngineNs : 0.0);
+                cases.add(juce::var(result));
+            }
+        }
+
+        auto* report = new juce::DynamicObject();
+        report->setProperty("sampleRate", settings.sampleRate);
+        report->setProperty("secondsPerCase", settings.secondsPerCase);
+        report->setProperty("cases", cases);
+        return juce::var(report);
+    }
+
+    struct LevelSetting
+    {
+        const char* name;
+        float gain;
+    };
+
+    // Live against frozen, for both fold positions the frozen mode covers and a short,
+    // medium and long tail. Both engines get the same input from the start; the timed
+    // pass begins once the frozen one has handed over and its live path has rung out.
+    juce::var runFrozen(const BenchmarkSettings& settings, const juce::AudioBuffer<float>& input)
+    {
+        constexpr int numChannels = 2;
+        constexpr int blockSize = 512;
+        const int frozenPositions[] = { WavefoldReverbEngine::PRE_REVERB, WavefoldReverbEngine::POST_REVERB };
+        const float sizes[] = { 0.2f, 0.5f, 0.9f };
+
+        // -40 dB, where the fold is close to linear, and the programme level
+        const LevelSetting levels[] = { { "quiet", 0.01f }, { "programme", 1.0f } };
+
+        juce::Array<juce::var> cases;
+
+        for (auto position : frozenPositions)
+        {
+            for (auto size : sizes)
+            {
+                for (const auto& level : levels)
+                {
+                    WavefoldReverbEngine::Parameters params;
+                    params.wavefoldPosition = position;
+                    params.size = size;
+                    params.preDelay = 20.0f;
+                    params.dryWet = 1.0f;
+
+                    auto frozenParams = params;
+                    frozenParams.reverbMode = 1;
+
+                    const juce::dsp::ProcessSpec spec { settings.sampleRate, (juce::uint32) blockSize, (juce::uint32) numChannels };
+                    WavefoldReverbEngine live, frozen;
+                    live.setParameters(params);
+                    live.prepare(spec);
+                    frozen.setParameters(frozenParams);
+                    frozen.prepare(spec);
+
+                    juce::AudioBuffer<float> liveBlock(numChannels, blockSize), frozenBlock(numChannels, blockSize);
+                    const int inputBlocks = input.getNumSamples() / blockSize;
+                    int nextBlock = 0;
+                    juce::ScopedNoDenormals noDenormals;
+
+                    auto processBoth = [&]
+                    {
+                        for (int channel = 0; channel < numChannels; ++channel)
+                        {
+                            liveBlock.copyFrom(channel, 0, input, channel, (nextBlock % inputBlocks) * blockSize, blockSize);
+                            liveBlock.applyGain(channel, 0, blockSize, level.gain);
+                            frozenBlock.copyFrom(channel, 0, liveBlock, channel, 0, blockSize);
+                        }
+
+                        ++nextBlock;
+
+                        const auto start = std::chrono::steady_clock::now();
+                        live.setParameters(params);
+                        live.process(liveBlock);
+                        const auto middle = std::chrono::steady_clock::now();
+                        frozen.setParameters(frozenParams);
+                        frozen.process(frozenBlock);
+                        const auto end = std::chrono::steady_clock::now();
+
+                        return std::make_pair((double) std::chrono::duration_cast<std::chrono::nanoseconds>(middle - start).count(),
+                                              (double) std::chrono::duration_cast<std::chrono::nanoseconds>(end - middle).count());
+                    };
+
+                    // Runs until the capture has landed and the convolution has taken over
+                    const auto captureStart = std::chrono::steady_clock::now();
+                    const auto captureDeadline = captureStart + std::chrono::seconds(60);
+
+                    while (! frozen.isFrozen() && std::chrono::steady_clock::now() < captureDeadline)
+                        processBoth();
+
+                    const double captureSeconds = frozen.isFrozen()
+                        ? std::chrono::duration<double>(std::chrono::steady_clock::now() - captureStart).count() : -1.0;
+
+                    // Then until the live path inside the frozen engine has rung out
+                    const int tailBlocks = (int) std::ceil(frozen.getTailLengthSeconds() * settings.sampleRate / blockSize);
+
+                    for (int b = 0; b < tailBlocks; ++b)
+                        processBoth();
+
+                    double liveNanos = 0.0, frozenNanos = 0.0, errorEnergy = 0.0, signalEnergy = 0.0;
+
+                    for (int b = 0; b < inputBlocks; ++b)
+                    {
+                        const auto nanos = processBoth();
+                        liveNanos += nanos.first;
+                        frozenNanos += nanos.second;
+
+                        for (int channel = 0; channel < numChannels; ++channel)
+                        {
+                            const float* liveData = liveBlock.getReadPointer(channel);
+                            const float* frozenData = frozenBlock.getReadPointer(channel);
+
+                            for (int sample = 0; sample < blockSize; ++sample)
+                            {
+                                const double difference = (double) frozenData[sample] - (double) liveData[sample];
+                                errorEnergy += difference * difference;
+                                signalEnergy += (double) liveData[sample] * (double) liveData[sample];
+                            }
+                        }
+                    }
+
+                    const double processedSamples = (double) inputBlocks * blockSize * numChannels;
+                    const double liveNs = liveNanos / processedSamples;
+                    const double frozenNs = frozenNanos / processedSamples;
+
+                    auto* result = new juce::DynamicObject();
+                    result->setProperty("wavefoldPosition", positionNames[position]);
+                    result->setProperty("size", size);
+                    result->setProperty("inputLevel", level.name);
+                    result->setProperty("channels", numChannels);
+                    result->setProperty("blockSize", blockSize);
+                    result->setProperty("tailSeconds", frozen.getTailLengthSeconds());
+                    result->setProperty("frozen", frozen.isFrozen());
+                    result->setProperty("captureSeconds", captureSeconds);
+                    result->setProperty("liveNsPerSample", liveNs);
+                    result->setProperty("frozenNsPerSample", frozenNs);
+                    result->setProperty("frozenOverLive", liveNs > 0.0 ? frozenNs / liveNs : 0.0);
+                    result->setProperty("errorDecibels", signalEnergy > 0.0 && errorEnergy > 0.0
+                                                             ? 10.0 * std::log10(errorEnergy / signalEnergy) : -200.0);
+                    cases.add(juce::var(result));
+                }
+            }
+        }
+
+        auto* report = new juce::DynamicObject();
+        report->setProperty("sampleRate", settings.sampleRate);
+        report->setProperty("secondsPerCase", settings.secondsPerCase);
+        report->setProperty("cases", cases);
+        return juce::var(report);
+    }
+
+    // Frozen instances at one setting, all kept alive, as in a session full of them
+    juce::var runInstances(const BenchmarkSettings& settings, const juce::AudioBuffer<float>& input)
+    {
+        constexpr int numChannels = 2;
+        constexpr int blockSize = 512;
+        constexpr int numInstances = 200;
+        const int reportedInstances[] = { 1, 2, 10, 50, 100, 200 };
+
+        WavefoldReverbEngine::Parameters params;
+        params.preDelay = 20.0f;
+        params.reverbMode = 1;
+
+        const juce::dsp::ProcessSpec spec { settings.sampleRate, (juce::uint32) blockSize, (juce::uint32) numChannels };
+        const int inputBlocks = input.getNumSamples() / blockSize;
+
+        std::vector<std::unique_ptr<WavefoldReverbEngine>> engines;
+        juce::AudioBuffer<float> block(numChannels, blockSize);
+        juce::Array<juce::var> cases;
+
+        for (int instance = 1; instance <= numInstances; ++instance)
+        {
+            const auto heapBefore = getHeapBytesInUse();
+            const auto start = std::chrono::steady_clock::now();
+            const auto deadline = start + std::chrono::seconds(60);
+
+            engines.push_back(std::make_unique<WavefoldReverbEngine>());
+            auto& engine = *engines.back();
+            engine.setParameters(params);
+            engine.prepare(spec);
+
+            // The capture thread is polled, so give it a moment between blocks
+            for (int b = 0; ! engine.isFrozen() && std::chrono::steady_clock::now() < deadline; ++b)
+            {
+                for (int channel = 0; channel < numChannels; ++channel)
+                    block.copyFrom(channel, 0, input, channel, (b % inputBlocks) * blockSize, blockSize);
+
+                engine.setParameters(params);
+                engine.process(block);
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+
+            const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            const auto heapAfter = getHeapBytesInUse();
+
+            if (std::find(std::begin(reportedInstances), std::end(reportedInstances), instance) == std::end(reportedInstances))
+                continue;
+
+            auto* result = new juce::DynamicObject();
+            result->setProperty("instance", instance);
+            result->setProperty("frozen", engine.isFrozen());
+            result->setProperty("secondsToFrozen", engine.isFrozen() ? seconds : -1.0);
+            result->setProperty("heapBytes", heapBefore >= 0 && heapAfter >= 0 ? heapAfter - heapBefore : (juce::int64) -1);
+            cases.add(juce::var(result));
+        }
+
+        auto* report = new juce::DynamicObject();
+        report->setProperty("sampleRate", settings.sampleRate);
+        report->setProperty("channels", numChannels);
+        report->setProperty("blockSize", blockSize);
+        report->setProperty("tailSeconds", engines.front()->getTailLengthSeconds());
+        report->setProperty("cases", cases);
+        return juce::var(report);
+    }
+
+    void writeReport(const BenchmarkSettings& settings, const juce::var& report)
+    {
+        const auto json = juce::JSON::toString(report);
+
+        if (settings.outputFile != juce::File())
+            settings.outputFile.replaceWithText(json);
+        else
+            std::cout << json << std::endl;
+    }
+
+    bool parseArguments(int argc, char* argv[], BenchmarkSettings& settings)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            const juce::String arg(argv[i]);
+            const bool hasValue = i + 1 < argc;
+
+            if (arg == "--seconds" && hasValue)
+                settings.secondsPerCase = juce::jmax(0.05, juce::String(argv[++i]).getDoubleValue());
+            else if (arg == "--sample-rate" && hasValue)
+                settings.sampleRate = juce::jmax(8000.0, juce::String(argv[++i]).getDoubleValue());
+            else if (arg == "--fold-stress")
+                settings.foldStress = true;
+            else if (arg == "--precision")
+                settings.precision = true;
+            else if (arg == "--footprint")
+                settings.footprint = true;
+            else if (arg == "--density")
+                settings.density = true;
+            else if (arg == "--frozen")
+                settings.frozen = true;
+            else if (arg == "--instances")
+                settings.instances = true;
+            else if (arg == "--output" && hasValue)
+                settings.outputFile = juce::File::getCurrentWorkingDirectory().getChildFile(argv[++i]);
+            else
+                return false;
+        }
+
+        return true;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    BenchmarkSettings settings;
+
+    if (! parseArguments(argc, argv, settings))
+    {
+        std::cerr << "Usage: WavefoldReverbBenchmark [--seconds <s>] [--sample-rate <Hz>] [--fold-stress | --precision | --footprint | --density | --frozen | --instances] "
+                     "[--output <file.json>]" << std::endl;
+        return 1;
+    }
+
+    const int maxBlockSize = blockSizes[std::size(blockSizes) - 1];
+    const int inputLength = juce::jmax(maxBlockSize, (int) (settings.secondsPerCase * settings.sampleRate));
+
+    const int maxChannels = channelCounts[std::size(channelCounts) - 1];
+
+    juce::AudioBuffer<float> input(maxChannels, inputLength);
+    fillInput(input, settings.sampleRate);
+
+    if (settings.foldStress)
+    {
+        const auto report = runFoldStress(settings, input);
+        writeReport(settings, report);
+
+        bool withinBounds = true;
+
+        if (! (bool) report["simdWithinBound"])
+        {
+            std::cerr << "Wavefolder block path exceeds its error bound against process()" << std::endl;
+            withinBounds = false;
+        }
+
+        if (! (bool) report["antiderivativesWithinBound"])
+        {
+            std::cerr << "Fold antiderivatives do not differentiate back to their fold curves" << std::endl;
+            withinBounds = false;
+        }
+
+        return withinBounds ? 0 : 2;
+    }
+
+    if (settings.precision)
+    {
+        writeReport(settings, runPrecision(settings, input));
+        return 0;
+    }
+
+    if (settings.footprint)
+    {
+        writeReport(settings, runFootprint(settings, input));
+        return 0;
+    }
+
+    if (settings.density)
+    {
+        writeReport(settings, runDensity(settings, input));
+        return 0;
+    }
+
+    if (settings.frozen)
+    {
+        writeReport(settings, runFrozen(settings, input));
+        return 0;
+    }
+
+    if (settings.instances)
+    {
+        writeReport(settings, runInstances(settings, input));
+        return 0;
+    }
+
+    juce::Array<juce::var> results;
+
+    for (int position = 0; position < (int) std::size(positionNames); ++position)
+    {
+        // Only the in-loop network depends on the line count
+        const int numLineChoices = position == WavefoldReverbEngine::IN_REVERB_LOOP ? 2 : 1;
+
+        for (const auto& shape : shapes)
+            for (const auto& fold : foldSettings)
+                for (auto numChannels : channelCounts)
+                    for (auto blockSize : blockSizes)
+                        for (int fdnLines = 0; fdnLines < numLineChoices; ++fdnLines)
+                            results.add(runCase(settings, input, position, shape, fold, numChannels, blockSize, fdnLines));
+    }
+
+    auto* report = new juce::DynamicObject();
+    report->setProperty("sampleRate", settings.sampleRate);
+    report->setProperty("secondsPerCase", settings.secondsPerCase);
+    report->setProperty("cases", results);
+
+    writeReport(settings, juce::var(report));
+    return 0;
+}
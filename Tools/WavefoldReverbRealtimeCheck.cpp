@@ -0,0 +1,796 @@
+// Real-time safety checker for WavefoldReverbEngine.
+//
+// Replaces the allocator, the pthread lock and wait calls and the libc wrappers of the
+// usual blocking system calls for this executable, and records every call the audio
+// thread makes while a block is being processed, with its stack. Other threads (e.g. the
+// fold table baker) and everything outside the block (prepare(), building the parameter
+// script) are free to do all of these.
+//
+// Every wavefoldPosition x oversampling x antialiasing x fdnLines x foldMode x reverbMode
+// combination is checked in float and double, for mono, stereo and 5.1, at host block
+// sizes below, at and above the prepared maximum block size. Frozen cases first process
+// blocks until the convolution has taken over, sleeping between them, so the swap and
+// the frozen path are checked too; a case that hasn't frozen by freezeTimeout fails.
+// Within each case every parameter then moves on the audio thread, one per block:
+// continuous ones to both ends of their range and back, choices through every other
+// value and back. The input then goes silent until the chain falls asleep and comes
+// back to wake it, so reset() runs on the audio thread too.
+//
+// Prints one JSON document with each distinct offending stack, the call it made and the
+// first case that hit it. Allocation, lock and system call interception needs glibc;
+// elsewhere only operator new and delete are checked.
+//
+// Usage: WavefoldReverbRealtimeCheck [--sample-rate <Hz>] [--block-size <prepared samples>]
+//                                    [--output <file.json>]
+
+#include <juce_core/juce_core.h>
+#include "WavefoldReverbEngine.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <thread>
+
+#if defined (__GLIBC__)
+ #define WAVEFOLD_REVERB_RT_CHECK_GLIBC 1
+ #include <dlfcn.h>
+ #include <execinfo.h>
+ #include <poll.h>
+ #include <pthread.h>
+ #include <semaphore.h>
+ #include <sched.h>
+ #include <sys/mman.h>
+ #include <time.h>
+ #include <unistd.h>
+ #include <cerrno>
+
+extern "C"
+{
+    void* __libc_malloc(size_t size);
+    void* __libc_calloc(size_t count, size_t size);
+    void* __libc_realloc(void* pointer, size_t size);
+    void* __libc_memalign(size_t alignment, size_t size);
+    void __libc_free(void* pointer);
+}
+#else
+ #define WAVEFOLD_REVERB_RT_CHECK_GLIBC 0
+#endif
+
+namespace rtcheck
+{
+    constexpr int maxFrames = 32;
+    constexpr int maxViolations = 64;
+
+    // One distinct offending stack. Filled in from inside the hooks, so it's all fixed size.
+    struct Violation
+    {
+        const char* call = nullptr;
+        int firstCase = -1;
+        int count = 0;
+        int numFrames = 0;
+        void* frames[maxFrames] = {};
+    };
+
+    Violation violations[maxViolations];
+    int numViolations = 0;
+    int numDroppedViolations = 0;
+    int currentCase = -1;
+
+    // Only the thread running a block is checked, and never while it is recording
+    thread_local bool checking = false;
+    thread_local bool recording = false;
+
+    void flag(const char* call) noexcept
+    {
+        if (! checking || recording)
+            return;
+
+        recording = true;
+
+        void* frames[maxFrames];
+        int numFrames = 0;
+
+       #if WAVEFOLD_REVERB_RT_CHECK_GLIBC
+        numFrames = backtrace(frames, maxFrames);
+       #endif
+
+        bool found = false;
+
+        for (int i = 0; i < numViolations && ! found; ++i)
+        {
+            auto& violation = violations[i];
+
+            if (violation.call == call && violation.numFrames == numFrames
+                && std::memcmp(violation.frames, frames, sizeof (void*) * (size_t) numFrames) == 0)
+            {
+                ++violation.count;
+                found = true;
+            }
+        }
+
+        if (! found)
+        {
+            if (numViolations < maxViolations)
+            {
+                auto& violation = violations[numViolations++];
+                violation.call = call;
+                violation.firstCase = currentCase;
+                violation.count = 1;
+                violation.numFrames = numFrames;
+                std::memcpy(violation.frames, frames, sizeof (void*) * (size_t) numFrames);
+            }
+            else
+            {
+                ++numDroppedViolations;
+            }
+        }
+
+        recording = false;
+    }
+
+    // Marks the calling thread as the audio thread for its lifetime
+    struct ScopedAudioThread
+    {
+        ScopedAudioThread() noexcept { checking = true; }
+        ~ScopedAudioThread() noexcept { checking = false; }
+    };
+
+    // The allocator underneath the hooks, so operator new isn't reported twice
+   #if WAVEFOLD_REVERB_RT_CHECK_GLIBC
+    void* allocate(std::size_t size) noexcept { return __libc_malloc(size); }
+    void* allocateAligned(std::size_t size, std::size_t alignment) noexcept { return __libc_memalign(alignment, size); }
+    void release(void* pointer) noexcept { __libc_free(pointer); }
+   #else
+    void* allocate(std::size_t size) noexcept { return std::malloc(size); }
+    void release(void* pointer) noexcept { std::free(pointer); }
+   #endif
+
+   #if WAVEFOLD_REVERB_RT_CHECK_GLIBC
+    // The next definition of a libc function, looked up on first use
+    template <typename Function>
+    Function next(Function& cached, const char* name) noexcept
+    {
+        if (cached == nullptr)
+            cached = reinterpret_cast<Function>(dlsym(RTLD_NEXT, name));
+
+        return cached;
+    }
+   #endif
+}
+
+//==============================================================================
+// Allocation
+
+void* operator new(std::size_t size)
+{
+    rtcheck::flag("operator new");
+
+    if (auto* pointer = rtcheck::allocate(size > 0 ? size : 1))
+        return pointer;
+
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size)
+{
+    rtcheck::flag("operator new[]");
+
+    if (auto* pointer = rtcheck::allocate(size > 0 ? size : 1))
+        return pointer;
+
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    rtcheck::flag("operator new");
+    return rtcheck::allocate(size > 0 ? size : 1);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    rtcheck::flag("operator new[]");
+    return rtcheck::allocate(size > 0 ? size : 1);
+}
+
+void operator delete(void* pointer) noexcept
+{
+    if (pointer != nullptr)
+        rtcheck::flag("operator delete");
+
+    rtcheck::release(pointer);
+}
+
+void operator delete[](void* pointer) noexcept
+{
+    if (pointer != nullptr)
+        rtcheck::flag("operator delete[]");
+
+    rtcheck::release(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept { operator delete(pointer); }
+void operator delete[](void* pointer, std::size_t) noexcept { operator delete[](pointer); }
+void operator delete(void* pointer, const std::nothrow_t&) noexcept { operator delete(pointer); }
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept { operator delete[](pointer); }
+
+#if WAVEFOLD_REVERB_RT_CHECK_GLIBC
+// Over-aligned forms; only replaced where the matching aligned free is plain free()
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+    rtcheck::flag("operator new");
+
+    if (auto* pointer = rtcheck::allocateAligned(size > 0 ? size : 1, (std::size_t) alignment))
+        return pointer;
+
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment)
+{
+    rtcheck::flag("operator new[]");
+
+    if (auto* pointer = rtcheck::allocateAligned(size > 0 ? size : 1, (std::size_t) alignment))
+        return pointer;
+
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    rtcheck::flag("operator new");
+    return rtcheck::allocateAligned(size > 0 ? size : 1, (std::size_t) alignment);
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    rtcheck::flag("operator new[]");
+    return rtcheck::allocateAligned(size > 0 ? size : 1, (std::size_t) alignment);
+}
+
+void operator delete(void* pointer, std::align_val_t) noexcept { operator delete(pointer); }
+void operator delete[](void* pointer, std::align_val_t) noexcept { operator delete[](pointer); }
+void operator delete(void* pointer, std::size_t, std::align_val_t) noexcept { operator delete(pointer); }
+void operator delete[](void* pointer, std::size_t, std::align_val_t) noexcept { operator delete[](pointer); }
+void operator delete(void* pointer, std::align_val_t, const std::nothrow_t&) noexcept { operator delete(pointer); }
+void operator delete[](void* pointer, std::align_val_t, const std::nothrow_t&) noexcept { operator delete[](pointer); }
+
+extern "C"
+{
+    void* malloc(size_t size) noexcept
+    {
+        rtcheck::flag("malloc");
+        return __libc_malloc(size);
+    }
+
+    void* calloc(size_t count, size_t size) noexcept
+    {
+        rtcheck::flag("calloc");
+        return __libc_calloc(count, size);
+    }
+
+    void* realloc(void* pointer, size_t size) noexcept
+    {
+        rtcheck::flag("realloc");
+        return __libc_realloc(pointer, size);
+    }
+
+    void free(void* pointer) noexcept
+    {
+        if (pointer != nullptr)
+            rtcheck::flag("free");
+
+        __libc_free(pointer);
+    }
+
+    void* memalign(size_t alignment, size_t size) noexcept
+    {
+        rtcheck::flag("memalign");
+        return __libc_memalign(alignment, size);
+    }
+
+    void* aligned_alloc(size_t alignment, size_t size) noexcept
+    {
+        rtcheck::flag("aligned_alloc");
+        return __libc_memalign(alignment, size);
+    }
+
+    int posix_memalign(void** result, size_t alignment, size_t size) noexcept
+    {
+        rtcheck::flag("posix_memalign");
+
+        if (alignment % sizeof (void*) != 0 || (alignment & (alignment - 1)) != 0)
+            return EINVAL;
+
+        *result = __libc_memalign(alignment, size);
+        return *result != nullptr ? 0 : ENOMEM;
+    }
+
+    //==============================================================================
+    // Locks and waits
+
+    int pthread_mutex_lock(pthread_mutex_t* mutex) noexcept
+    {
+        static int (*real)(pthread_mutex_t*) = nullptr;
+        rtcheck::flag("pthread_mutex_lock");
+        return rtcheck::next(real, "pthread_mutex_lock")(mutex);
+    }
+
+    int pthread_mutex_trylock(pthread_mutex_t* mutex) noexcept
+    {
+        static int (*real)(pthread_mutex_t*) = nullptr;
+        rtcheck::flag("pthread_mutex_trylock");
+        return rtcheck::next(real, "pthread_mutex_trylock")(mutex);
+    }
+
+    int pthread_rwlock_rdlock(pthread_rwlock_t* lock) noexcept
+    {
+        static int (*real)(pthread_rwlock_t*) = nullptr;
+        rtcheck::flag("pthread_rwlock_rdlock");
+        return rtcheck::next(real, "pthread_rwlock_rdlock")(lock);
+    }
+
+    int pthread_rwlock_wrlock(pthread_rwlock_t* lock) noexcept
+    {
+        static int (*real)(pthread_rwlock_t*) = nullptr;
+        rtcheck::flag("pthread_rwlock_wrlock");
+        return rtcheck::next(real, "pthread_rwlock_wrlock")(lock);
+    }
+
+    int pthread_cond_wait(pthread_cond_t* condition, pthread_mutex_t* mutex)
+    {
+        static int (*real)(pthread_cond_t*, pthread_mutex_t*) = nullptr;
+        rtcheck::flag("pthread_cond_wait");
+        return rtcheck::next(real, "pthread_cond_wait")(condition, mutex);
+    }
+
+    int pthread_cond_timedwait(pthread_cond_t* condition, pthread_mutex_t* mutex, const struct timespec* time)
+    {
+        static int (*real)(pthread_cond_t*, pthread_mutex_t*, const struct timespec*) = nullptr;
+        rtcheck::flag("pthread_cond_timedwait");
+        return rtcheck::next(real, "pthread_cond_timedwait")(condition, mutex, time);
+    }
+
+    int pthread_cond_signal(pthread_cond_t* condition) noexcept
+    {
+        static int (*real)(pthread_cond_t*) = nullptr;
+        rtcheck::flag("pthread_cond_signal");
+        return rtcheck::next(real, "pthread_cond_signal")(condition);
+    }
+
+    int pthread_cond_broadcast(pthread_cond_t* condition) noexcept
+    {
+        static int (*real)(pthread_cond_t*) = nullptr;
+        rtcheck::flag("pthread_cond_broadcast");
+        return rtcheck::next(real, "pthread_cond_broadcast")(condition);
+    }
+
+    int sem_wait(sem_t* semaphore)
+    {
+        static int (*real)(sem_t*) = nullptr;
+        rtcheck::flag("sem_wait");
+        return rtcheck::next(real, "sem_wait")(semaphore);
+    }
+
+    int sem_post(sem_t* semaphore) noexcept
+    {
+        static int (*real)(sem_t*) = nullptr;
+        rtcheck::flag("sem_post");
+        return rtcheck::next(real, "sem_post")(semaphore);
+    }
+
+    //==============================================================================
+    // System calls
+
+    ssize_t read(int descriptor, void* data, size_t size)
+    {
+        static ssize_t (*real)(int, void*, size_t) = nullptr;
+        rtcheck::flag("read");
+        return rtcheck::next(real, "read")(descriptor, data, size);
+    }
+
+    ssize_t write(int descriptor, const void* data, size_t size)
+    {
+        static ssize_t (*real)(int, const void*, size_t) = nullptr;
+        rtcheck::flag("write");
+        return rtcheck::next(real, "write")(descriptor, data, size);
+    }
+
+    int close(int descriptor)
+    {
+        static int (*real)(int) = nullptr;
+        rtcheck::flag("close");
+        return rtcheck::next(real, "close")(descriptor);
+    }
+
+    int poll(struct pollfd* descriptors, nfds_t count, int timeout)
+    {
+        static int (*real)(struct pollfd*, nfds_t, int) = nullptr;
+        rtcheck::flag("poll");
+        return rtcheck::next(real, "poll")(descriptors, count, timeout);
+    }
+
+    int nanosleep(const struct timespec* duration, struct timespec* remaining)
+    {
+        static int (*real)(const struct timespec*, struct timespec*) = nullptr;
+        rtcheck::flag("nanosleep");
+        return rtcheck::next(real, "nanosleep")(duration, remaining);
+    }
+
+    int clock_nanosleep(clockid_t clock, int flags, const struct timespec* duration, struct timespec* remaining)
+    {
+        static int (*real)(clockid_t, int, const struct timespec*, struct timespec*) = nullptr;
+        rtcheck::flag("clock_nanosleep");
+        return rtcheck::next(real, "clock_nanosleep")(clock, flags, duration, remaining);
+    }
+
+    int usleep(useconds_t duration)
+    {
+        static int (*real)(useconds_t) = nullptr;
+        rtcheck::flag("usleep");
+        return rtcheck::next(real, "usleep")(duration);
+    }
+
+    int sched_yield() noexcept
+    {
+        static int (*real)() = nullptr;
+        rtcheck::flag("sched_yield");
+        return rtcheck::next(real, "sched_yield")();
+    }
+
+    void* mmap(void* address, size_t length, int protection, int flags, int descriptor, off_t offset) noexcept
+    {
+        static void* (*real)(void*, size_t, int, int, int, off_t) = nullptr;
+        rtcheck::flag("mmap");
+        return rtcheck::next(real, "mmap")(address, length, protection, flags, descriptor, offset);
+    }
+
+    int munmap(void* address, size_t length) noexcept
+    {
+        static int (*real)(void*, size_t) = nullptr;
+        rtcheck::flag("munmap");
+        return rtcheck::next(real, "munmap")(address, length);
+    }
+}
+#endif
+
+//==============================================================================
+namespace
+{
+    struct CheckSettings
+    {
+        double sampleRate = 48000.0;
+        int blockSize = 256;
+        juce::File outputFile;
+    };
+
+    using Parameters = WavefoldReverbEngine::Parameters;
+    using ParameterMask = WavefoldReverbEngine::ParameterMask;
+
+    // Ranges as in the plugin's parameter layout
+    struct ContinuousParameter
+    {
+        float Parameters::* value;
+        float minimum, maximum;
+    };
+
+    const ContinuousParameter continuousParameters[] = {
+        { &Parameters::size, 0.0f, 1.0f },
+        { &Parameters::decay, 0.1f, 20.0f },
+        { &Parameters::diffusion, 0.0f, 1.0f },
+        { &Parameters::density, 0.0f, 1.0f },
+        { &Parameters::lowEQ, 0.0f, 1.0f },
+        { &Parameters::midEQ, 0.0f, 1.0f },
+        { &Parameters::highEQ, 0.0f, 1.0f },
+        { &Parameters::drive, 1.0f, 10.0f },
+        { &Parameters::threshold, 0.1f, 1.0f },
+        { &Parameters::offset, -1.0f, 1.0f },
+        { &Parameters::fundamental, 20.0f, 5000.0f },
+        { &Parameters::foldSymmetry, 0.0f, 1.0f },
+        { &Parameters::waveformShape, 0.0f, 1.0f },
+        { &Parameters::dryWet, 0.0f, 1.0f },
+        { &Parameters::preDelay, 0.0f, 500.0f }
+    };
+
+    struct ChoiceParameter
+    {
+        int Parameters::* value;
+        const char* name;
+        int numChoices;
+    };
+
+    const ChoiceParameter choiceParameters[] = {
+        { &Parameters::wavefoldPosition, "wavefoldPosition", 3 },
+        { &Parameters::oversampling, "oversampling", WavefoldReverbEngine::maxOversamplingOrder + 1 },
+        { &Parameters::antialiasing, "antialiasing", 3 },
+        { &Parameters::fdnLines, "fdnLines", 2 },
+        { &Parameters::foldMode, "foldMode", 2 },
+        { &Parameters::reverbMode, "reverbMode", 2 }
+    };
+
+    constexpr int numChoiceParameters = (int) std::size(choiceParameters);
+
+    const int channelCounts[] = { 1, 2, 6 };
+
+    // The parameters for each block of a case, built before the audio thread runs
+    std::vector<Parameters> makeScript(const Parameters& base)
+    {
+        std::vector<Parameters> script;
+        script.push_back(base);
+
+        for (const auto& parameter : continuousParameters)
+        {
+            for (auto value : { parameter.minimum, parameter.maximum })
+            {
+                auto moved = base;
+                moved.*parameter.value = value;
+                script.push_back(moved);
+            }
+
+            script.push_back(base);
+        }
+
+        for (const auto& parameter : choiceParameters)
+        {
+            for (int choice = 0; choice < parameter.numChoices; ++choice)
+            {
+                if (choice == base.*parameter.value)
+                    continue;
+
+                auto moved = base;
+                moved.*parameter.value = choice;
+                script.push_back(moved);
+            }
+
+            script.push_back(base);
+        }
+
+        return script;
+    }
+
+    juce::String describeCase(const int choices[], int numChannels, int blockSize, bool isDouble)
+    {
+        juce::String description;
+
+        for (int i = 0; i < numChoiceParameters; ++i)
+            description << choiceParameters[i].name << "=" << choices[i] << " ";
+
+        return description << "channels=" << numChannels << " hostBlock=" << blockSize
+                           << " precision=" << (isDouble ? "double" : "float");
+    }
+
+    struct CaseResult
+    {
+        bool froze = true;
+        bool slept = false;
+        bool woke = false;
+    };
+
+    // Longest a frozen case may wait for its capture to land
+    constexpr auto freezeTimeout = std::chrono::seconds(10);
+
+    // Renders one case; only setParameters() and process() run as the audio thread
+    template <typename SampleType>
+    CaseResult runCase(BasicWavefoldReverbEngine<SampleType>& engine, const CheckSettings& settings,
+                       const Parameters& base, int numChannels, int hostBlockSize)
+    {
+        const auto script = makeScript(base);
+
+        engine.setParameters(base);
+        engine.prepare({ settings.sampleRate, (juce::uint32) settings.blockSize, (juce::uint32) numChannels });
+
+        juce::AudioBuffer<SampleType> block(numChannels, hostBlockSize);
+        juce::Random random(0x5eed);
+
+        auto fillBlock = [&] (bool silent)
+        {
+            for (int channel = 0; channel < numChannels; ++channel)
+            {
+                auto* data = block.getWritePointer(channel);
+
+                for (int sample = 0; sample < hostBlockSize; ++sample)
+                    data[sample] = silent ? (SampleType) 0 : (SampleType) (random.nextFloat() - 0.5f);
+            }
+        };
+
+        auto processBlock = [&] (const Parameters& params)
+        {
+            // Stands in for the processor's parameter listeners
+            const auto changed = WavefoldReverbEngine::getChangedParameters(engine.getParameters(), params);
+
+            juce::ScopedNoDenormals noDenormals;
+            rtcheck::ScopedAudioThread audioThread;
+            engine.setParameters(params, changed);
+            engine.process(block);
+        };
+
+        CaseResult result;
+
+        // The capture runs on its own thread, so give it real time between blocks
+        if (base.reverbMode == 1 && base.wavefoldPosition != WavefoldReverbEngine::IN_REVERB_LOOP)
+        {
+            const auto deadline = std::chrono::steady_clock::now() + freezeTimeout;
+
+            for (;;)
+            {
+                fillBlock(false);
+                processBlock(base);
+
+                if (engine.isFrozen())
+                    break;
+
+                if (std::chrono::steady_clock::now() > deadline)
+                {
+                    result.froze = false;
+                    break;
+                }
+
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+
+        for (const auto& params : script)
+        {
+            fillBlock(false);
+            processBlock(params);
+        }
+
+        // Fully dry, the output follows the input under the gate as soon as it stops
+        auto quiet = base;
+        quiet.dryWet = 0.0f;
+
+        const int maxSilentSamples = (int) settings.sampleRate;
+
+        for (int silentSamples = 0; silentSamples < maxSilentSamples && ! result.slept; silentSamples += hostBlockSize)
+        {
+            fillBlock(true);
+            processBlock(quiet);
+            result.slept = engine.isSleeping();
+        }
+
+        fillBlock(false);
+        processBlock(base);
+        result.woke = ! engine.isSleeping();
+        return result;
+    }
+
+    juce::var runChecks(const CheckSettings& settings)
+    {
+        const int hostBlockSizes[] = { 1, settings.blockSize / 4, settings.blockSize, settings.blockSize * 4 - 23 };
+
+        WavefoldReverbEngine floatEngine;
+        WavefoldReverbEngineDouble doubleEngine;
+
+        juce::StringArray caseNames;
+        int numCases = 0, numCasesNotSleeping = 0, numCasesNotFrozen = 0;
+        int choices[numChoiceParameters] = {};
+
+        // Odometer over every combination of the choice parameters
+        for (;;)
+        {
+            Parameters base;
+
+            for (int i = 0; i < numChoiceParameters; ++i)
+                base.*choiceParameters[i].value = choices[i];
+
+            for (auto numChannels : channelCounts)
+            {
+                for (auto hostBlockSize : hostBlockSizes)
+                {
+                    for (bool isDouble : { false, true })
+                    {
+                        caseNames.add(describeCase(choices, numChannels, hostBlockSize, isDouble));
+                        rtcheck::currentCase = numCases++;
+
+                        const auto result = isDouble ? runCase(doubleEngine, settings, base, numChannels, hostBlockSize)
+                                                     : runCase(floatEngine, settings, base, numChannels, hostBlockSize);
+
+                        if (! result.slept || ! result.woke)
+                            ++numCasesNotSleeping;
+
+                        if (! result.froze)
+                            ++numCasesNotFrozen;
+                    }
+                }
+            }
+
+            int digit = 0;
+
+            while (digit < numChoiceParameters && ++choices[digit] == choiceParameters[digit].numChoices)
+                choices[digit++] = 0;
+
+            if (digit == numChoiceParameters)
+                break;
+        }
+
+        juce::Array<juce::var> violations;
+
+        for (int i = 0; i < rtcheck::numViolations; ++i)
+        {
+            const auto& violation = rtcheck::violations[i];
+            juce::Array<juce::var> stack;
+
+           #if WAVEFOLD_REVERB_RT_CHECK_GLIBC
+            if (auto* symbols = backtrace_symbols(violation.frames, violation.numFrames))
+            {
+                for (int frame = 0; frame < violation.numFrames; ++frame)
+                    stack.add(juce::String(symbols[frame]));
+
+                free(symbols);
+            }
+           #endif
+
+            auto* result = new juce::DynamicObject();
+            result->setProperty("call", juce::String(violation.call));
+            result->setProperty("count", violation.count);
+            result->setProperty("firstCase", caseNames[violation.firstCase]);
+            result->setProperty("stack", stack);
+            violations.add(juce::var(result));
+        }
+
+        auto* report = new juce::DynamicObject();
+        report->setProperty("sampleRate", settings.sampleRate);
+        report->setProperty("preparedBlockSize", settings.blockSize);
+        report->setProperty("interceptsSystemCalls", WAVEFOLD_REVERB_RT_CHECK_GLIBC != 0);
+        report->setProperty("cases", numCases);
+        report->setProperty("casesWithoutSleepAndWake", numCasesNotSleeping);
+        report->setProperty("casesNotFrozen", numCasesNotFrozen);
+        report->setProperty("droppedStacks", rtcheck::numDroppedViolations);
+        report->setProperty("realtimeSafe", rtcheck::numViolations == 0);
+        report->setProperty("violations", violations);
+        return juce::var(report);
+    }
+
+    bool parseArguments(int argc, char* argv[], CheckSettings& settings)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            const juce::String arg(argv[i]);
+            const bool hasValue = i + 1 < argc;
+
+            if (arg == "--sample-rate" && hasValue)
+                settings.sampleRate = juce::jmax(8000.0, juce::String(argv[++i]).getDoubleValue());
+            else if (arg == "--block-size" && hasValue)
+                settings.blockSize = juce::jlimit(16, 4096, juce::String(argv[++i]).getIntValue());
+            else if (arg == "--output" && hasValue)
+                settings.outputFile = juce::File::getCurrentWorkingDirectory().getChildFile(argv[++i]);
+            else
+                return false;
+        }
+
+        return true;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    CheckSettings settings;
+
+    if (! parseArguments(argc, argv, settings))
+    {
+        std::cerr << "Usage: WavefoldReverbRealtimeCheck [--sample-rate <Hz>] [--block-size <n>] "
+                     "[--output <file.json>]" << std::endl;
+        return 1;
+    }
+
+   #if WAVEFOLD_REVERB_RT_CHECK_GLIBC
+    // The first backtrace() loads the unwinder, which allocates; get that over with here
+    void* frames[1];
+    backtrace(frames, 1);
+   #endif
+
+    const auto report = runChecks(settings);
+    const auto json = juce::JSON::toString(report);
+
+    if (settings.outputFile != juce::File())
+        settings.outputFile.replaceWithText(json);
+    else
+        std::cout << json << std::endl;
+
+    // Non-zero exit so CI notices the audio thread allocating, locking or blocking, or the
+    // frozen path going unchecked
+    return report["realtimeSafe"] && (int) report["casesNotFrozen"] == 0 ? 0 : 2;
+}
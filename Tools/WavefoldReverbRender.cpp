@@ -0,0 +1,774 @@
+// Parallel batch renderer for WavefoldReverbEngine.
+//
+// Renders every input audio file through the effect with one preset and writes a WAV of
+// the same name (and, for directory inputs, the same relative path) to the output
+// directory. Inputs can be files, directories (searched recursively for any format JUCE
+// reads) or, with --list, a text file of paths, one per line.
+//
+// Files are spread over a work-stealing pool with one worker per core. Each worker owns
+// one preallocated engine that is re-prepared only when a file's sample rate or channel
+// count differs from the last one, and otherwise just reset between files. Jobs are dealt
+// out longest first; a worker whose own queue runs dry steals from the back of the
+// others', so one long stem doesn't leave the other cores idle at the end.
+//
+// Files are streamed, never loaded whole, so memory use doesn't grow with their length.
+// WAV and AIFF input is read through a memory-mapped window that slides along the file;
+// other formats use their own streaming reader. Output goes through a double-buffered
+// writer: a background thread per worker writes one slot to disk while the render fills
+// the other, so disk I/O overlaps with the DSP.
+//
+// The preset is a saved plugin state: the XML the plugin writes, with one
+// <PARAM id="..." value="..."/> per parameter. Missing parameters keep their defaults.
+//
+// Prints one JSON document with every file's result and the overall throughput, as a
+// real-time multiple in total and per worker thread, plus the time the render waited on
+// the disk and the process's peak resident memory.
+//
+// Usage: WavefoldReverbRender --preset <state.xml> --output <directory>
+//                             [--threads <N>] [--block-size <samples>] [--tail]
+//                             [--list <paths.txt>] [--report <file.json>] [inputs...]
+
+#include <juce_audio_formats/juce_audio_formats.h>
+#include "WavefoldReverbEngine.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+#if defined (__linux__) || defined (__APPLE__)
+ #include <sys/resource.h>
+#endif
+
+namespace
+{
+    struct RenderSettings
+    {
+        juce::File presetFile;
+        juce::File outputDirectory;
+        juce::File reportFile;
+        juce::Array<juce::File> inputs;
+        juce::Array<juce::File> listFiles;
+        int numThreads = juce::jmax(1, (int) std::thread::hardware_concurrency());
+        int blockSize = 1024;
+        bool renderTail = false;
+    };
+
+    // Longest tail appended with --tail, however long the reverb rings
+    constexpr double maxTailSeconds = 60.0;
+
+    // Blocks per slot of the double-buffered writer
+    constexpr int writerSlotBlocks = 16;
+
+    struct Job
+    {
+        juce::File input;
+        juce::File output;
+        juce::int64 lengthInSamples = 0;
+    };
+
+    struct JobResult
+    {
+        bool succeeded = false;
+        juce::String error;
+        int worker = -1;
+        double sampleRate = 0.0;
+        int numChannels = 0;
+        juce::int64 samplesWritten = 0;
+        double seconds = 0.0;
+        bool memoryMapped = false;
+        double writerStallSeconds = 0.0;
+        double writeSeconds = 0.0;
+    };
+
+    //==============================================================================
+    // Work-stealing pool: every worker owns a queue of jobs, takes from its front and,
+    // once that is empty, steals from the back of another worker's. Jobs are all queued
+    // before run(), so a worker that finds every queue empty is done.
+    class WorkStealingPool
+    {
+    public:
+        explicit WorkStealingPool(int numWorkers)
+        {
+            for (int i = 0; i < numWorkers; ++i)
+                queues.push_back(std::make_unique<Queue>());
+        }
+
+        int getNumWorkers() const noexcept { return (int) queues.size(); }
+
+        void push(int worker, int job)
+        {
+            queues[(size_t) worker]->jobs.push_back(job);
+        }
+
+        void run(const std::function<void(int worker, int job)>& work)
+        {
+            std::vector<std::thread> threads;
+
+            for (int worker = 0; worker < getNumWorkers(); ++worker)
+            {
+                threads.emplace_back([this, worker, &work]
+                {
+                    int job;
+
+                    while (takeOwn(worker, job) || steal(worker, job))
+                        work(worker, job);
+                });
+            }
+
+            for (auto& thread : threads)
+                thread.join();
+        }
+
+        int getNumSteals() const noexcept { return numSteals.load(); }
+
+    private:
+        struct Queue
+        {
+            std::mutex lock;
+            std::deque<int> jobs;
+        };
+
+        bool takeOwn(int worker, int& job)
+        {
+            auto& queue = *queues[(size_t) worker];
+            const std::lock_guard<std::mutex> guard(queue.lock);
+
+            if (queue.jobs.empty())
+                return false;
+
+            job = queue.jobs.front();
+            queue.jobs.pop_front();
+            return true;
+        }
+
+        // Victims in turn, starting after the thief, so thieves spread over the queues
+        bool steal(int thief, int& job)
+        {
+            for (int offset = 1; offset < getNumWorkers(); ++offset)
+            {
+                auto& queue = *queues[(size_t) ((thief + offset) % getNumWorkers())];
+                const std::lock_guard<std::mutex> guard(queue.lock);
+
+                if (! queue.jobs.empty())
+                {
+                    job = queue.jobs.back();
+                    queue.jobs.pop_back();
+                    ++numSteals;
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        std::vector<std::unique_ptr<Queue>> queues;
+        std::atomic<int> numSteals { 0 };
+    };
+
+    //==============================================================================
+    // Input through a sliding memory-mapped window where the format has a mapped reader
+    // (WAV, AIFF), so only the window's pages are ever resident however long the file
+    // is. Other formats fall back to their own streaming reader.
+    class StreamingReader
+    {
+    public:
+        StreamingReader(juce::AudioFormatManager& formatManager, const juce::File& file)
+        {
+            if (auto* format = formatManager.findFormatForFileExtension(file.getFileExtension()))
+                mapped.reset(format->createMemoryMappedReader(file));
+
+            if (mapped == nullptr)
+                streamed.reset(formatManager.createReaderFor(file));
+        }
+
+        juce::AudioFormatReader* get() const noexcept
+        {
+            return mapped != nullptr ? static_cast<juce::AudioFormatReader*>(mapped.get()) : streamed.get();
+        }
+
+        bool isMemoryMapped() const noexcept { return mapped != nullptr; }
+
+        // Past the end of the file the destination is filled with silence
+        bool read(juce::AudioBuffer<float>& destination, int numSamples, juce::int64 position)
+        {
+            auto* reader = get();
+
+            if (mapped != nullptr)
+            {
+                const juce::Range<juce::int64> needed(position, juce::jmin(reader->lengthInSamples, position + numSamples));
+
+                // Mapping the next window releases the previous one
+                if (! needed.isEmpty() && ! mapped->getMappedSection().contains(needed)
+                    && ! mapped->mapSectionOfFile({ position, juce::jmin(reader->lengthInSamples, position + windowSamples) }))
+                    return false;
+            }
+
+            return reader->read(&destination, 0, numSamples, position, true, true);
+        }
+
+    private:
+        static constexpr juce::int64 windowSamples = 1 << 20;
+
+        std::unique_ptr<juce::MemoryMappedAudioFormatReader> mapped;
+        std::unique_ptr<juce::AudioFormatReader> streamed;
+    };
+
+    //==============================================================================
+    // Output through two slots and a writer thread: the render fills one slot while the
+    // thread writes the other, so DSP and disk I/O overlap, and the render only waits
+    // when the disk falls a whole slot behind. One per worker, reused for every file.
+    class DoubleBufferedWriter
+    {
+    public:
+        DoubleBufferedWriter()
+        {
+            thread = std::thread([this] { run(); });
+        }
+
+        ~DoubleBufferedWriter()
+        {
+            {
+                const std::lock_guard<std::mutex> guard(lock);
+                quit = true;
+            }
+
+            changed.notify_all();
+            thread.join();
+        }
+
+        void prepare(int numChannels, int slotSize)
+        {
+            for (auto& slot : slots)
+                slot.buffer.setSize(numChannels, slotSize, false, false, true);
+        }
+
+        // Only between files, while the writer thread has nothing to do
+        void start(std::unique_ptr<juce::AudioFormatWriter> newWriter)
+        {
+            writer = std::move(newWriter);
+            failed = false;
+            stallSeconds = 0.0;
+            writeSeconds = 0.0;
+        }
+
+        bool write(const juce::AudioBuffer<float>& block, int numSamples)
+        {
+            for (int offset = 0; offset < numSamples;)
+            {
+                auto& slot = slots[(size_t) fillIndex];
+
+                if (fillPosition == 0)
+                    waitUntilWritten(slot);
+
+                const int count = juce::jmin(numSamples - offset, slot.buffer.getNumSamples() - fillPosition);
+
+                for (int channel = 0; channel < slot.buffer.getNumChannels(); ++channel)
+                    slot.buffer.copyFrom(channel, fillPosition, block, channel, offset, count);
+
+                fillPosition += count;
+                offset += count;
+
+                if (fillPosition == slot.buffer.getNumSamples())
+                    submit();
+            }
+
+            // The writer thread may be setting it right now
+            const std::lock_guard<std::mutex> guard(lock);
+            return ! failed;
+        }
+
+        // Hands over the partly filled slot, waits for the disk and closes the file
+        bool finish()
+        {
+            if (fillPosition > 0)
+                submit();
+
+            for (auto& slot : slots)
+                waitUntilWritten(slot);
+
+            // Read after the last waitUntilWritten(), so the writer thread is done with it
+            writer.reset();
+            return ! failed;
+        }
+
+        // Time the render spent waiting for the disk, and the time spent writing
+        double getStallSeconds() const noexcept { return stallSeconds; }
+        double getWriteSeconds() const noexcept { return writeSeconds; }
+
+    private:
+        struct Slot
+        {
+            juce::AudioBuffer<float> buffer;
+            int numSamples = 0;
+            bool full = false;
+        };
+
+        void submit()
+        {
+            {
+                const std::lock_guard<std::mutex> guard(lock);
+                slots[(size_t) fillIndex].numSamples = fillPosition;
+                slots[(size_t) fillIndex].full = true;
+            }
+
+            changed.notify_all();
+
+            // Both sides alternate and finish() drains them, so they stay in step across files
+            fillIndex ^= 1;
+            fillPosition = 0;
+        }
+
+        void waitUntilWritten(Slot& slot)
+        {
+            std::unique_lock<std::mutex> guard(lock);
+
+            if (! slot.full)
+                return;
+
+            const auto start = std::chrono::steady_clock::now();
+            changed.wait(guard, [&slot] { return ! slot.full; });
+            stallSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+
+        void run()
+        {
+            int writeIndex = 0;
+            std::unique_lock<std::mutex> guard(lock);
+
+            for (;;)
+            {
+                changed.wait(guard, [this, writeIndex] { return quit || slots[(size_t) writeIndex].full; });
+
+                auto& slot = slots[(size_t) writeIndex];
+
+                if (! slot.full)
+                    return;
+
+                guard.unlock();
+                const auto start = std::chrono::steady_clock::now();
+                const bool written = writer->writeFromAudioSampleBuffer(slot.buffer, 0, slot.numSamples);
+                const auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                guard.lock();
+
+                writeSeconds += seconds;
+                failed = failed || ! written;
+                slot.full = false;
+                changed.notify_all();
+                writeIndex ^= 1;
+            }
+        }
+
+        std::array<Slot, 2> slots;
+        std::unique_ptr<juce::AudioFormatWriter> writer;
+
+        // Render side
+        int fillIndex = 0;
+        int fillPosition = 0;
+        double stallSeconds = 0.0;
+
+        // Shared, under the lock
+        std::mutex lock;
+        std::condition_variable changed;
+        double writeSeconds = 0.0;
+        bool failed = false;
+        bool quit = false;
+
+        // Last, so everything it touches exists before it starts
+        std::thread thread;
+    };
+
+    // Peak resident set size of the whole process so far, or -1 where it isn't known
+    juce::int64 getPeakResidentBytes()
+    {
+       #if defined (__linux__) || defined (__APPLE__)
+        rusage usage {};
+
+        if (getrusage(RUSAGE_SELF, &usage) != 0)
+            return -1;
+
+        #if defined (__APPLE__)
+         return (juce::int64) usage.ru_maxrss;
+        #else
+         return (juce::int64) usage.ru_maxrss * 1024;
+        #endif
+       #else
+        return -1;
+       #endif
+    }
+
+    //==============================================================================
+    // One per pool worker, allocated up front and reused for every file it renders
+    struct Worker
+    {
+        WavefoldReverbEngine engine;
+        juce::AudioBuffer<float> buffer;
+        DoubleBufferedWriter output;
+        double preparedSampleRate = 0.0;
+        int preparedChannels = 0;
+        double busySeconds = 0.0;
+        int numFiles = 0;
+    };
+
+    bool loadPreset(const juce::File& file, WavefoldReverbEngine::Parameters& params, juce::String& error)
+    {
+        auto xml = juce::parseXML(file);
+
+        if (xml == nullptr)
+        {
+            error = "can't read preset " + file.getFullPathName();
+            return false;
+        }
+
+        for (auto* child : xml->getChildWithTagNameIterator("PARAM"))
+        {
+            const auto id = child->getStringAttribute("id");
+
+            if (child->hasAttribute("value") && ! WavefoldReverbEngine::setParameter(params, id, (float) child->getDoubleAttribute("value")))
+                std::cerr << "Ignoring unknown parameter " << id << std::endl;
+        }
+
+        return true;
+    }
+
+    JobResult renderJob(Worker& worker, const Job& job, juce::AudioFormatManager& formatManager,
+                        const WavefoldReverbEngine::Parameters& params, const RenderSettings& settings)
+    {
+        JobResult result;
+        const auto start = std::chrono::steady_clock::now();
+
+        StreamingReader input(formatManager, job.input);
+        auto* reader = input.get();
+
+        if (reader == nullptr)
+        {
+            result.error = "can't read " + job.input.getFullPathName();
+            return result;
+        }
+
+        result.sampleRate = reader->sampleRate;
+        result.numChannels = (int) reader->numChannels;
+        result.memoryMapped = input.isMemoryMapped();
+
+        // Re-prepare only when the format changes; otherwise a reset is enough
+        if (reader->sampleRate != worker.preparedSampleRate || result.numChannels != worker.preparedChannels)
+        {
+            worker.engine.setParameters(params);
+            worker.engine.prepare({ reader->sampleRate, (juce::uint32) settings.blockSize, (juce::uint32) result.numChannels });
+            worker.buffer.setSize(result.numChannels, settings.blockSize);
+            worker.output.prepare(result.numChannels, settings.blockSize * writerSlotBlocks);
+            worker.preparedSampleRate = reader->sampleRate;
+            worker.preparedChannels = result.numChannels;
+        }
+        else
+        {
+            worker.engine.reset();
+        }
+
+        job.output.getParentDirectory().createDirectory();
+        job.output.deleteFile();
+
+        const int bitsPerSample = reader->usesFloatingPointData ? 32 : juce::jlimit(16, 32, (int) reader->bitsPerSample);
+        std::unique_ptr<juce::AudioFormatWriter> writer;
+
+        if (auto stream = std::make_unique<juce::FileOutputStream>(job.output); stream->openedOk())
+        {
+            writer.reset(juce::WavAudioFormat().createWriterFor(stream.get(), reader->sampleRate, reader->numChannels,
+                                                                bitsPerSample, {}, 0));
+
+            if (writer != nullptr)
+                stream.release(); // now owned by the writer
+        }
+
+        if (writer == nullptr)
+        {
+            result.error = "can't write " + job.output.getFullPathName();
+            return result;
+        }
+
+        worker.output.start(std::move(writer));
+
+        const juce::int64 tailSamples = settings.renderTail
+            ? (juce::int64) std::ceil(juce::jmin(maxTailSeconds, worker.engine.getTailLengthSeconds()) * reader->sampleRate)
+            : 0;
+        const juce::int64 totalSamples = reader->lengthInSamples + tailSamples;
+
+        for (juce::int64 position = 0; position < totalSamples && result.error.isEmpty(); position += settings.blockSize)
+        {
+            const int numSamples = (int) juce::jmin((juce::int64) settings.blockSize, totalSamples - position);
+
+            // Past the end the reader fills with silence, which renders the tail
+            if (! input.read(worker.buffer, numSamples, position))
+            {
+                result.error = "read failed for " + job.input.getFullPathName();
+                break;
+            }
+
+            juce::AudioBuffer<float> block(worker.buffer.getArrayOfWritePointers(), result.numChannels, numSamples);
+            worker.engine.setParameters(params);
+            worker.engine.process(block);
+
+            if (! worker.output.write(block, numSamples))
+                result.error = "write failed for " + job.output.getFullPathName();
+        }
+
+        // Always closes the file, so the writer is free for the next one
+        if (! worker.output.finish() && result.error.isEmpty())
+            result.error = "write failed for " + job.output.getFullPathName();
+
+        result.succeeded = result.error.isEmpty();
+        result.samplesWritten = result.succeeded ? totalSamples : 0;
+        result.writerStallSeconds = worker.output.getStallSeconds();
+        result.writeSeconds = worker.output.getWriteSeconds();
+        result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return result;
+    }
+
+    // Input files with where each one's output goes
+    juce::Array<Job> collectJobs(const RenderSettings& settings, juce::AudioFormatManager& formatManager)
+    {
+        juce::Array<juce::File> files, roots;
+
+        auto addInput = [&] (const juce::File& input)
+        {
+            if (input.isDirectory())
+            {
+                for (const auto& file : input.findChildFiles(juce::File::findFiles, true, formatManager.getWildcardForAllFormats()))
+                {
+                    files.add(file);
+                    roots.add(input);
+                }
+            }
+            else
+            {
+                files.add(input);
+                roots.add(input.getParentDirectory());
+            }
+        };
+
+        for (const auto& input : settings.inputs)
+            addInput(input);
+
+        for (const auto& list : settings.listFiles)
+        {
+            juce::StringArray lines;
+            lines.addLines(list.loadFileAsString());
+
+            for (const auto& line : lines)
+                if (line.trim().isNotEmpty())
+                    addInput(list.getParentDirectory().getChildFile(line.trim()));
+        }
+
+        juce::Array<Job> jobs;
+
+        for (int i = 0; i < files.size(); ++i)
+        {
+            Job job;
+            job.input = files[i];
+            job.output = settings.outputDirectory.getChildFile(files[i].getRelativePathFrom(roots[i]))
+                                                 .withFileExtension(".wav");
+
+            if (std::unique_ptr<juce::AudioFormatReader> reader { formatManager.createReaderFor(files[i]) })
+                job.lengthInSamples = reader->lengthInSamples;
+
+            jobs.add(job);
+        }
+
+        return jobs;
+    }
+
+    bool parseArguments(int argc, char* argv[], RenderSettings& settings)
+    {
+        const auto cwd = juce::File::getCurrentWorkingDirectory();
+
+        for (int i = 1; i < argc; ++i)
+        {
+            const juce::String arg(argv[i]);
+            const bool hasValue = i + 1 < argc;
+
+            if (arg == "--preset" && hasValue)
+                settings.presetFile = cwd.getChildFile(argv[++i]);
+            else if (arg == "--output" && hasValue)
+                settings.outputDirectory = cwd.getChildFile(argv[++i]);
+            else if (arg == "--threads" && hasValue)
+                settings.numThreads = juce::jlimit(1, 1024, juce::String(argv[++i]).getIntValue());
+            else if (arg == "--block-size" && hasValue)
+                settings.blockSize = juce::jlimit(16, 65536, juce::String(argv[++i]).getIntValue());
+            else if (arg == "--tail")
+                settings.renderTail = true;
+            else if (arg == "--list" && hasValue)
+                settings.listFiles.add(cwd.getChildFile(argv[++i]));
+            else if (arg == "--report" && hasValue)
+                settings.reportFile = cwd.getChildFile(argv[++i]);
+            else if (! arg.startsWith("--"))
+                settings.inputs.add(cwd.getChildFile(arg));
+            else
+                return false;
+        }
+
+        return settings.presetFile != juce::File() && settings.outputDirectory != juce::File();
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    RenderSettings settings;
+
+    if (! parseArguments(argc, argv, settings))
+    {
+        std::cerr << "Usage: WavefoldReverbRender --preset <state.xml> --output <directory> [--threads <N>] "
+                     "[--block-size <n>] [--tail] [--list <paths.txt>] [--report <file.json>] [inputs...]" << std::endl;
+        return 1;
+    }
+
+    WavefoldReverbEngine::Parameters params;
+    juce::String error;
+
+    if (! loadPreset(settings.presetFile, params, error))
+    {
+        std::cerr << error << std::endl;
+        return 1;
+    }
+
+    // The frozen mode hands over whenever its background capture lands, which offline is
+    // an arbitrary point in the file; render the live path it stands in for
+    params.reverbMode = 0;
+
+    juce::AudioFormatManager formatManager;
+    formatManager.registerBasicFormats();
+
+    auto jobs = collectJobs(settings, formatManager);
+
+    if (jobs.isEmpty())
+    {
+        std::cerr << "No input files" << std::endl;
+        return 1;
+    }
+
+    if (! settings.outputDirectory.createDirectory())
+    {
+        std::cerr << "Can't create " << settings.outputDirectory.getFullPathName() << std::endl;
+        return 1;
+    }
+
+    // Longest first, dealt round robin, so the long files start right away
+    std::vector<int> order((size_t) jobs.size());
+
+    for (size_t i = 0; i < order.size(); ++i)
+        order[i] = (int) i;
+
+    std::stable_sort(order.begin(), order.end(), [&jobs] (int a, int b)
+    {
+        return jobs.getReference(a).lengthInSamples > jobs.getReference(b).lengthInSamples;
+    });
+
+    const int numWorkers = juce::jmin(settings.numThreads, jobs.size());
+    WorkStealingPool pool(numWorkers);
+
+    for (size_t i = 0; i < order.size(); ++i)
+        pool.push((int) (i % (size_t) numWorkers), order[i]);
+
+    std::vector<std::unique_ptr<Worker>> workers;
+
+    for (int i = 0; i < numWorkers; ++i)
+        workers.push_back(std::make_unique<Worker>());
+
+    std::vector<JobResult> results((size_t) jobs.size());
+    const auto start = std::chrono::steady_clock::now();
+
+    pool.run([&] (int workerIndex, int jobIndex)
+    {
+        auto& worker = *workers[(size_t) workerIndex];
+        auto result = renderJob(worker, jobs.getReference(jobIndex), formatManager, params, settings);
+        result.worker = workerIndex;
+        worker.busySeconds += result.seconds;
+        ++worker.numFiles;
+        results[(size_t) jobIndex] = result;
+    });
+
+    const double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    juce::Array<juce::var> files;
+    double audioSeconds = 0.0, writeSeconds = 0.0, writerStallSeconds = 0.0;
+    int numFailed = 0;
+
+    for (int i = 0; i < jobs.size(); ++i)
+    {
+        const auto& result = results[(size_t) i];
+        const double fileSeconds = result.sampleRate > 0.0 ? result.samplesWritten / result.sampleRate : 0.0;
+        audioSeconds += fileSeconds;
+        writeSeconds += result.writeSeconds;
+        writerStallSeconds += result.writerStallSeconds;
+
+        if (! result.succeeded)
+            ++numFailed;
+
+        auto* file = new juce::DynamicObject();
+        file->setProperty("input", jobs.getReference(i).input.getFullPathName());
+        file->setProperty("output", jobs.getReference(i).output.getFullPathName());
+        file->setProperty("succeeded", result.succeeded);
+
+        if (result.succeeded)
+        {
+            file->setProperty("worker", result.worker);
+            file->setProperty("sampleRate", result.sampleRate);
+            file->setProperty("channels", result.numChannels);
+            file->setProperty("audioSeconds", fileSeconds);
+            file->setProperty("renderSeconds", result.seconds);
+            file->setProperty("realtimeMultiple", result.seconds > 0.0 ? fileSeconds / result.seconds : 0.0);
+            file->setProperty("memoryMapped", result.memoryMapped);
+            file->setProperty("writeSeconds", result.writeSeconds);
+            file->setProperty("writerStallSeconds", result.writerStallSeconds);
+        }
+        else
+        {
+            file->setProperty("error", result.error);
+        }
+
+        files.add(juce::var(file));
+    }
+
+    juce::Array<juce::var> workerLoads;
+
+    for (const auto& worker : workers)
+    {
+        auto* load = new juce::DynamicObject();
+        load->setProperty("files", worker->numFiles);
+        load->setProperty("busyFraction", wallSeconds > 0.0 ? worker->busySeconds / wallSeconds : 0.0);
+        workerLoads.add(juce::var(load));
+    }
+
+    const double realtimeMultiple = wallSeconds > 0.0 ? audioSeconds / wallSeconds : 0.0;
+
+    auto* report = new juce::DynamicObject();
+    report->setProperty("preset", settings.presetFile.getFullPathName());
+    report->setProperty("threads", numWorkers);
+    report->setProperty("hardwareThreads", (int) std::thread::hardware_concurrency());
+    report->setProperty("files", jobs.size());
+    report->setProperty("failed", numFailed);
+    report->setProperty("audioSeconds", audioSeconds);
+    report->setProperty("wallSeconds", wallSeconds);
+    report->setProperty("realtimeMultiple", realtimeMultiple);
+    report->setProperty("realtimeMultiplePerCore", realtimeMultiple / numWorkers);
+    report->setProperty("steals", pool.getNumSteals());
+    report->setProperty("writeSeconds", writeSeconds);
+    report->setProperty("writerStallSeconds", writerStallSeconds);
+    report->setProperty("peakResidentBytes", getPeakResidentBytes());
+    report->setProperty("workers", workerLoads);
+    report->setProperty("results", files);
+
+    const auto json = juce::JSON::toString(juce::var(report));
+
+    if (settings.reportFile != juce::File())
+        settings.reportFile.replaceWithText(json);
+    else
+        std::cout << json << std::endl;
+
+    // Non-zero exit so batch scripts notice files that didn't render
+    return numFailed > 0 ? 2 : 0;
+}
@@ -0,0 +1,319 @@
+// Multi-instance scaling harness for WavefoldReverbEngine.
+//
+// Runs N engine instances (1 to 512, doubling) on N threads at once, each rendering the
+// same input with the same parameters, and prints one JSON document with the aggregate
+// throughput, speedup over one instance and scaling efficiency for every N. Efficiency
+// is measured against min(N, hardware threads), since more threads than cores can't
+// scale any further.
+//
+// Two checks flag problems that break scaling in large sessions:
+//  - shared mutable state: every instance's output must be bit-identical to one instance
+//    rendered alone. Any mismatch means instances read or write state they share.
+//  - false sharing: each N runs twice, once with the instances packed back to back in one
+//    allocation and once with each instance on its own cache lines, allocated by its own
+//    thread. If the isolated layout is clearly faster, hot data of neighbouring instances
+//    shares cache lines.
+//
+// Usage: WavefoldReverbScaling [--seconds <audio seconds per instance>] [--sample-rate <Hz>]
+//                              [--block-size <samples>] [--max-instances <N>]
+//                              [--output <file.json>]
+
+#include <juce_core/juce_core.h>
+#include "WavefoldReverbEngine.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+namespace
+{
+    struct ScalingSettings
+    {
+        double secondsPerInstance = 1.0;
+        double sampleRate = 48000.0;
+        int blockSize = 256;
+        int maxInstances = 512;
+        juce::File outputFile;
+    };
+
+    // Isolated layout: one instance per allocation, starting on its own cache line, with
+    // nothing else after it on its last one
+    struct alignas (64) IsolatedEngine
+    {
+        WavefoldReverbEngine engine;
+        char padding[64];
+    };
+
+    struct InstanceResult
+    {
+        juce::uint64 checksum = 0;
+        double nanos = 0.0;
+    };
+
+    // Deterministic programme-like input, as in the benchmark
+    void fillInput(juce::AudioBuffer<float>& buffer, double sampleRate)
+    {
+        juce::Random random(0x5eed);
+        const double phaseIncrement = juce::MathConstants<double>::twoPi * 220.0 / sampleRate;
+
+        for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+        {
+            float* data = buffer.getWritePointer(channel);
+
+            for (int sample = 0; sample < buffer.getNumSamples(); ++sample)
+            {
+                const float tone = (float) std::sin(phaseIncrement * sample);
+                const float noise = random.nextFloat() * 2.0f - 1.0f;
+                data[sample] = 0.35f * tone + 0.15f * noise;
+            }
+        }
+    }
+
+    WavefoldReverbEngine::Parameters makeParameters()
+    {
+        // Asymmetric fold in the pre-reverb position, so the DC blocker runs every block
+        WavefoldReverbEngine::Parameters params;
+        params.wavefoldPosition = WavefoldReverbEngine::PRE_REVERB;
+        params.drive = 4.0f;
+        params.threshold = 0.4f;
+        params.offset = 0.2f;
+        params.foldSymmetry = 0.7f;
+        params.preDelay = 20.0f;
+        return params;
+    }
+
+    // FNV-1a over the bit patterns of every output sample
+    void hashBlock(const juce::AudioBuffer<float>& block, juce::uint64& hash)
+    {
+        for (int channel = 0; channel < block.getNumChannels(); ++channel)
+        {
+            const float* data = block.getReadPointer(channel);
+
+            for (int sample = 0; sample < block.getNumSamples(); ++sample)
+            {
+                juce::uint32 bits;
+                std::memcpy(&bits, data + sample, sizeof (bits));
+                hash = (hash ^ bits) * 0x100000001b3ULL;
+            }
+        }
+    }
+
+    // Renders the whole input through one engine and returns its checksum and time
+    InstanceResult render(WavefoldReverbEngine& engine, const ScalingSettings& settings,
+                          const juce::AudioBuffer<float>& input)
+    {
+        const auto params = makeParameters();
+        const int numChannels = input.getNumChannels();
+        const int numBlocks = input.getNumSamples() / settings.blockSize;
+
+        engine.setParameters(params);
+        engine.prepare({ settings.sampleRate, (juce::uint32) settings.blockSize, (juce::uint32) numChannels });
+
+        juce::AudioBuffer<float> block(numChannels, settings.blockSize);
+        juce::ScopedNoDenormals noDenormals;
+        InstanceResult result;
+        result.checksum = 0xcbf29ce484222325ULL;
+
+        const auto start = std::chrono::steady_clock::now();
+
+        for (int b = 0; b < numBlocks; ++b)
+        {
+            for (int channel = 0; channel < numChannels; ++channel)
+                block.copyFrom(channel, 0, input, channel, b * settings.blockSize, settings.blockSize);
+
+            engine.setParameters(params);
+            engine.process(block);
+            hashBlock(block, result.checksum);
+        }
+
+        result.nanos = (double) std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+        return result;
+    }
+
+    // Runs numInstances engines on as many threads, all released at the same moment.
+    // Returns the wall time from release to the last thread finishing.
+    double runInstances(const ScalingSettings& settings, const juce::AudioBuffer<float>& input,
+                        int numInstances, bool isolated, std::vector<InstanceResult>& results)
+    {
+        results.assign((size_t) numInstances, {});
+
+        std::unique_ptr<WavefoldReverbEngine[]> packedEngines;
+
+        if (! isolated)
+            packedEngines.reset(new WavefoldReverbEngine[(size_t) numInstances]);
+
+        std::atomic<int> numReady { 0 };
+        std::atomic<bool> go { false };
+        std::vector<std::thread> threads;
+        threads.reserve((size_t) numInstances);
+
+        for (int i = 0; i < numInstances; ++i)
+        {
+            threads.emplace_back([&, i]
+            {
+                // Isolated engines are first touched by the thread that runs them
+                std::unique_ptr<IsolatedEngine> own;
+                auto* engine = isolated ? nullptr : &packedEngines[(size_t) i];
+
+                if (isolated)
+                {
+                    own = std::make_unique<IsolatedEngine>();
+                    engine = &own->engine;
+                }
+
+                ++numReady;
+
+                while (! go.load(std::memory_order_acquire))
+                    std::this_thread::yield();
+
+                const auto result = render(*engine, settings, input);
+
+                // Written once at the end, so neighbouring results can't slow the render
+                results[(size_t) i] = result;
+            });
+        }
+
+        while (numReady.load() < numInstances)
+            std::this_thread::yield();
+
+        const auto start = std::chrono::steady_clock::now();
+        go.store(true, std::memory_order_release);
+
+        for (auto& thread : threads)
+            thread.join();
+
+        return (double) std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    juce::var runScaling(const ScalingSettings& settings, const juce::AudioBuffer<float>& input)
+    {
+        const int hardwareThreads = juce::jmax(1, (int) std::thread::hardware_concurrency());
+        const double samplesPerInstance = (double) (input.getNumSamples() / settings.blockSize * settings.blockSize);
+
+        // Reference: one instance on its own
+        WavefoldReverbEngine referenceEngine;
+        const auto reference = render(referenceEngine, settings, input);
+
+        juce::Array<juce::var> cases;
+        double singleThroughput[2] = {};
+        bool anySharedState = false, anyFalseSharing = false;
+
+        for (int numInstances = 1; numInstances <= settings.maxInstances; numInstances *= 2)
+        {
+            double throughput[2] = {};
+            int mismatches = 0;
+            double slowestInstanceNanos = 0.0;
+
+            for (int layout = 0; layout < 2; ++layout)
+            {
+                std::vector<InstanceResult> results;
+                const double wallNanos = runInstances(settings, input, numInstances, layout == 1, results);
+                throughput[layout] = numInstances * samplesPerInstance / (wallNanos * 1.0e-9);
+
+                for (const auto& result : results)
+                {
+                    if (result.checksum != reference.checksum)
+                        ++mismatches;
+
+                    slowestInstanceNanos = juce::jmax(slowestInstanceNanos, result.nanos);
+                }
+            }
+
+            if (numInstances == 1)
+            {
+                singleThroughput[0] = throughput[0];
+                singleThroughput[1] = throughput[1];
+            }
+
+            const int idealSpeedup = juce::jmin(numInstances, hardwareThreads);
+            const double packedSpeedup = throughput[0] / singleThroughput[0];
+            const double isolatedSpeedup = throughput[1] / singleThroughput[1];
+
+            // The isolated layout only helps if neighbours were sharing cache lines
+            const bool falseSharingSuspected = numInstances > 1 && throughput[1] > throughput[0] * 1.1;
+            const bool sharedStateSuspected = mismatches > 0;
+            anySharedState = anySharedState || sharedStateSuspected;
+            anyFalseSharing = anyFalseSharing || falseSharingSuspected;
+
+            auto* result = new juce::DynamicObject();
+            result->setProperty("instances", numInstances);
+            result->setProperty("packedSamplesPerSecond", throughput[0]);
+            result->setProperty("isolatedSamplesPerSecond", throughput[1]);
+            result->setProperty("packedSpeedup", packedSpeedup);
+            result->setProperty("isolatedSpeedup", isolatedSpeedup);
+            result->setProperty("idealSpeedup", idealSpeedup);
+            result->setProperty("packedEfficiency", packedSpeedup / idealSpeedup);
+            result->setProperty("isolatedEfficiency", isolatedSpeedup / idealSpeedup);
+            result->setProperty("slowestInstanceRealTimeFactor",
+                                slowestInstanceNanos > 0.0 ? samplesPerInstance / settings.sampleRate * 1.0e9 / slowestInstanceNanos : 0.0);
+            result->setProperty("outputMismatches", mismatches);
+            result->setProperty("sharedStateSuspected", sharedStateSuspected);
+            result->setProperty("falseSharingSuspected", falseSharingSuspected);
+            cases.add(juce::var(result));
+        }
+
+        auto* report = new juce::DynamicObject();
+        report->setProperty("sampleRate", settings.sampleRate);
+        report->setProperty("blockSize", settings.blockSize);
+        report->setProperty("secondsPerInstance", settings.secondsPerInstance);
+        report->setProperty("hardwareThreads", hardwareThreads);
+        report->setProperty("engineBytes", (int) sizeof (WavefoldReverbEngine));
+        report->setProperty("sharedStateSuspected", anySharedState);
+        report->setProperty("falseSharingSuspected", anyFalseSharing);
+        report->setProperty("cases", cases);
+        return juce::var(report);
+    }
+
+    bool parseArguments(int argc, char* argv[], ScalingSettings& settings)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            const juce::String arg(argv[i]);
+            const bool hasValue = i + 1 < argc;
+
+            if (arg == "--seconds" && hasValue)
+                settings.secondsPerInstance = juce::jmax(0.05, juce::String(argv[++i]).getDoubleValue());
+            else if (arg == "--sample-rate" && hasValue)
+                settings.sampleRate = juce::jmax(8000.0, juce::String(argv[++i]).getDoubleValue());
+            else if (arg == "--block-size" && hasValue)
+                settings.blockSize = juce::jlimit(16, 4096, juce::String(argv[++i]).getIntValue());
+            else if (arg == "--max-instances" && hasValue)
+                settings.maxInstances = juce::jlimit(1, 512, juce::String(argv[++i]).getIntValue());
+            else if (arg == "--output" && hasValue)
+                settings.outputFile = juce::File::getCurrentWorkingDirectory().getChildFile(argv[++i]);
+            else
+                return false;
+        }
+
+        return true;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    ScalingSettings settings;
+
+    if (! parseArguments(argc, argv, settings))
+    {
+        std::cerr << "Usage: WavefoldReverbScaling [--seconds <s>] [--sample-rate <Hz>] [--block-size <n>] "
+                     "[--max-instances <N>] [--output <file.json>]" << std::endl;
+        return 1;
+    }
+
+    const int inputLength = juce::jmax(settings.blockSize, (int) (settings.secondsPerInstance * settings.sampleRate));
+    juce::AudioBuffer<float> input(2, inputLength);
+    fillInput(input, settings.sampleRate);
+
+    const auto report = runScaling(settings, input);
+    const auto json = juce::JSON::toString(report);
+
+    if (settings.outputFile != juce::File())
+        settings.outputFile.replaceWithText(json);
+    else
+        std::cout << json << std::endl;
+
+    // Non-zero exit so CI notices instances interfering with each other
+    return report["sharedStateSuspected"] ? 2 : 0;
+}